@@ -172,6 +172,24 @@ Matrix<double>* CompetitionEvaluator::getTurbineFitnesses() {
   return res;
 }
 
+bool CompetitionEvaluator::copyEnergyOutputs(double* out) {
+  if (!tspe) return false;
+  for (unsigned int i=0; i<tspe->rows; i++) {
+    for (unsigned int j=0; j<tspe->cols; j++) {
+      *out++=tspe->get(i, j);
+    }
+  }
+  return true;
+}
+
+bool CompetitionEvaluator::copyTurbineFitnesses(double* out) {
+  if (!tspe || !tfitnesses) return false;
+  for (unsigned int i=0; i<tfitnesses->rows; i++) {
+    out[i]=tfitnesses->get(i, 0);
+  }
+  return true;
+}
+
 bool CompetitionEvaluator::checkConstraint(Matrix<double>* layout) {
   static const double minDist=64.0*scenario.R*scenario.R;
   for (int i=0; i<layout->rows; i++) {
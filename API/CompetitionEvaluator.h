@@ -20,6 +20,8 @@ class CompetitionEvaluator : public WindFarmLayoutEvaluator {
 
     virtual Matrix<double>* getEnergyOutputs();
     virtual Matrix<double>* getTurbineFitnesses();
+    virtual bool copyEnergyOutputs(double* out);
+    virtual bool copyTurbineFitnesses(double* out);
     virtual double getEnergyOutput() {return energyCapture;};
     virtual double getWakeFreeRatio() {return wakeFreeRatio;};
     virtual double getEnergyCost() {return energyCost;};
@@ -0,0 +1,101 @@
+#include "CompiledScenario.h"
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <mutex>
+
+WakeCone::WakeCone(double k, double R, double CT) {
+  rkRatio=R/k;
+  krRatio=k/R;
+  alpha=atan(k);
+  cosAlpha=cos(alpha);
+  velocityDeficit=1.0-sqrt(1.0-CT);
+}
+
+CompiledScenario::CompiledScenario(const WindScenario& sc) :
+  scenario(sc), cone(sc.k, sc.R, sc.CT) {
+  minDistanceSquared=64.0*scenario.R*scenario.R;
+  int nd=scenario.thetas.rows;
+  rkCos.resize(nd);
+  rkSin.resize(nd);
+  squaredShape.resize(nd);
+  directionFreeEnergy.resize(nd);
+  directionOrder.resize(nd);
+  for (int thets=0; thets<nd; thets++) {
+    rkCos[thets]=cone.rkRatio*scenario.getCosMidThetas(thets);
+    rkSin[thets]=cone.rkRatio*scenario.getSinMidThetas(thets);
+    squaredShape[thets]=std::abs(scenario.ks.get(0, thets)-2)<0.0001;
+    directionFreeEnergy[thets]=directionPower<double>(thets, scenario.c.get(0, thets));
+    directionOrder[thets]=thets;
+  }
+  // order the directions by the energy a turbine gets from them without wake
+  std::sort(directionOrder.begin(), directionOrder.end(), [this](int a, int b) {
+    return directionFreeEnergy[a]>directionFreeEnergy[b];
+  });
+
+  // the obstacle grid has cells of the minimal distance between turbines,
+  // an obstacle is listed in every cell its rectangle touches
+  cellSize=8.0*scenario.R;
+  if (!(cellSize>0)) cellSize=std::max(1.0, std::max(scenario.width, scenario.height));
+  columns=std::max(1, (int)ceil(scenario.width/cellSize));
+  rows=std::max(1, (int)ceil(scenario.height/cellSize));
+  std::vector<std::vector<int> > cells(columns*rows);
+  for (unsigned int j=0; j<scenario.obstacles.rows; j++) {
+    int r0=cellIndex(scenario.obstacles.get(j, 1), rows);
+    int r1=cellIndex(scenario.obstacles.get(j, 3), rows);
+    int c0=cellIndex(scenario.obstacles.get(j, 0), columns);
+    int c1=cellIndex(scenario.obstacles.get(j, 2), columns);
+    for (int r=r0; r<=r1; r++) {
+      for (int c=c0; c<=c1; c++) {
+	cells[r*columns+c].push_back(j);
+      }
+    }
+  }
+  obstacleStarts.push_back(0);
+  for (const std::vector<int>& cell : cells) {
+    obstacleIndices.insert(obstacleIndices.end(), cell.begin(), cell.end());
+    obstacleStarts.push_back(obstacleIndices.size());
+  }
+}
+
+double CompiledScenario::costOfEnergy(int n, double wfr) const {
+  static const double ct  = 750000;
+  static const double cs  = 8000000;
+  static const double m   = 30;
+  static const double r   = 0.03;
+  static const double y   = 20;
+  static const double com = 20000;
+
+  if (wfr <= 0) return std::numeric_limits<double>::max();
+  return (((ct*n+cs*std::floor(n/m))*(0.666667+0.333333*std::exp(-0.00174*n*n))+com*n)/
+	  ((1.0-std::pow(1.0+r, -y))/r)/(8760.0*scenario.wakeFreeEnergy*wfr*n))+0.1/n;
+}
+
+std::shared_ptr<const CompiledScenario> CompiledScenario::load(const std::string& fileName) {
+  static std::mutex mutex;
+  static std::map<std::string, std::weak_ptr<const CompiledScenario> > cache;
+  std::lock_guard<std::mutex> lock(mutex);
+  std::shared_ptr<const CompiledScenario> compiled=cache[fileName].lock();
+  if (!compiled) {
+    compiled=std::make_shared<const CompiledScenario>(WindScenario(fileName));
+    cache[fileName]=compiled;
+  }
+  return compiled;
+}
+
+int CompiledScenario::cellIndex(double v, int count) const {
+  // clamped as a double, so that infinite and nan coordinates are safe
+  return (int)std::max(0.0, std::min(count-1.0, floor(v/cellSize)));
+}
+
+int CompiledScenario::obstacleAt(double x, double y) const {
+  int cell=cellIndex(y, rows)*columns+cellIndex(x, columns);
+  for (int i=obstacleStarts[cell]; i<obstacleStarts[cell+1]; i++) {
+    int j=obstacleIndices[i];
+    if (x > scenario.obstacles.get(j, 0) && x < scenario.obstacles.get(j, 2) &&
+	y > scenario.obstacles.get(j, 1) && y < scenario.obstacles.get(j, 3)) {
+      return j;
+    }
+  }
+  return -1;
+}
@@ -0,0 +1,166 @@
+#ifndef __COMPILED_SCENARIO_H__
+#define __COMPILED_SCENARIO_H__
+
+#include "WindScenario.h"
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * The wake cone of the Kusiak model for the turbine constants k, R and CT.
+ */
+struct WakeCone {
+  WakeCone(double k, double R, double CT);
+
+  // R/k, k/R, the half opening atan(k) and its cosine, and the velocity
+  // deficit right behind a turbine, 1-sqrt(1-CT)
+  double rkRatio;
+  double krRatio;
+  double alpha;
+  double cosAlpha;
+  double velocityDeficit;
+
+  /**
+   * The velocity deficit at an offset behind a turbine, or 0 outside of its
+   * wake. beta<alpha is tested as num>cos(alpha)*denom, without the acos of
+   * KusiakLayoutEvaluator::calculateBeta, so pairs right at the border of
+   * the cone may be decided differently; for approximations only.
+   * @param cosT The cosine of the wind direction
+   * @param sinT The sine of the wind direction
+   * @param dx The offset in x from the turbine causing the wake
+   * @param dy The offset in y from the turbine causing the wake
+   */
+  inline double deficit(double cosT, double sinT, double dx, double dy) const {
+    double along=dx*cosT+dy*sinT;
+    double a=dx+rkRatio*cosT;
+    double b=dy+rkRatio*sinT;
+    if (along+rkRatio<=cosAlpha*std::sqrt(a*a+b*b)) return 0;
+    return velocityDeficit/((1.0+krRatio*std::abs(along))*(1.0+krRatio*std::abs(along)));
+  }
+};
+
+/**
+ * The constants which the Kusiak wake model derives from a WindScenario:
+ * the direction and wake cone constants, the Weibull and power tables and an
+ * index of the obstacles. It is built once and never changed afterwards, so
+ * any number of evaluators and threads can share one instance through a
+ * shared_ptr without copying the scenario or locking.
+ */
+class CompiledScenario {
+  public:
+    /**
+     * Copies the scenario and derives the constants from it.
+     * @param sc The wind scenario
+     */
+    CompiledScenario(const WindScenario& sc);
+
+    /**
+     * Returns the compiled scenario of an xml file. The file is only read
+     * and compiled again when no earlier result is in use anymore, so the
+     * evaluators of a whole run share a single instance.
+     * @param fileName The scenario file
+     */
+    static std::shared_ptr<const CompiledScenario> load(const std::string& fileName);
+
+    const WindScenario scenario;
+
+    const WakeCone cone;
+    // the squared minimal distance between two turbines, (8R)^2
+    double minDistanceSquared;
+    // the middle of each direction times R/k
+    std::vector<double> rkCos;
+    std::vector<double> rkSin;
+
+    // whether the Weibull shape of a direction is 2 (within the tolerance
+    // of fastPow), where the power curve only needs a square
+    std::vector<bool> squaredShape;
+    // the energy of a turbine without wake per direction, and the
+    // directions ordered by decreasing energy
+    std::vector<double> directionFreeEnergy;
+    std::vector<int> directionOrder;
+
+    /**
+     * The annual energy of a turbine from a direction, for the given scale
+     * of the Weibull distribution of the wind speed.
+     * @param thets The direction
+     * @param cTurb The scale, reduced by the wake of the turbine
+     */
+    template <typename T>
+    double directionPower(int thets, double cTurb) const;
+
+    /**
+     * The cost of energy of a layout of n turbines with the given wake
+     * free ratio, or the maximum double if the ratio isn't positive.
+     */
+    double costOfEnergy(int n, double wfr) const;
+
+    /**
+     * Returns the first obstacle (in the order of the scenario) whose
+     * interior contains the point, or -1.
+     */
+    int obstacleAt(double x, double y) const;
+
+    template <typename T, bool SQUARED=false>
+    inline static T wblcdf(T x, T sc=1.0, T sh=1.0) {
+      T z=x/sc;
+      return T(1.0)-std::exp(-(SQUARED ? z*z : fastPow(z,sh)));
+    };
+
+    // faster because b is usually equal to 2!
+    template <typename T>
+    inline static T fastPow(T a, T b) {
+        if (std::abs(b-2)<T(0.0001)) {
+            return a*a;
+        } if (std::abs(b-1)<T(0.0001)) {
+            return a;
+        } if (std::abs(b)<T(0.0001)) {
+            return 1;
+        } else {
+            return std::pow(a,b);
+        }
+    }
+
+  private:
+    template <typename T, bool SQUARED>
+    double directionPowerShape(int thets, double cTurb) const;
+    // the row or column of the grid a coordinate falls into
+    int cellIndex(double v, int count) const;
+
+    // the obstacles overlapping each cell of a grid over the farm, in
+    // increasing order: the indices of cell i are obstacleIndices
+    // [obstacleStarts[i], obstacleStarts[i+1])
+    double cellSize;
+    int columns;
+    int rows;
+    std::vector<int> obstacleStarts;
+    std::vector<int> obstacleIndices;
+};
+
+template <typename T>
+double CompiledScenario::directionPower(int thets, double cTurb) const {
+  if (squaredShape[thets]) return directionPowerShape<T, true>(thets, cTurb);
+  return directionPowerShape<T, false>(thets, cTurb);
+}
+
+template <typename T, bool SQUARED>
+double CompiledScenario::directionPowerShape(int thets, double cTurb) const {
+  T c=cTurb;
+  T ki=scenario.ks.get(0, thets);
+  int nvints=scenario.vints.cols;
+  // the probability of each bin times its power, from the Weibull
+  // distribution at the bin borders
+  const double* P=scenario.binPower.data();
+  T totalPow=0;
+  T lower=wblcdf<T, SQUARED>(scenario.vints.get(0, 0), c, ki);
+  for (int ghh=1; ghh<nvints; ghh++) {
+    T upper=wblcdf<T, SQUARED>(scenario.vints.get(0, ghh), c, ki);
+    totalPow+=(upper-lower)*T(P[ghh-1]);
+    lower=upper;
+  }
+  totalPow+=T(scenario.PRated)*(T(1.0)-wblcdf<T, SQUARED>(scenario.vRated, c, ki));
+  totalPow*=T(scenario.directionWeights[thets]);
+  return totalPow;
+}
+
+#endif /* defined(__COMPILED_SCENARIO_H__) */
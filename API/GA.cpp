@@ -6,6 +6,7 @@
 #include <stdlib.h>
 #include <cstdlib>
 #include <time.h>
+#include <algorithm>
 
 #include "GA.h"
 #include "WindScenario.h"
@@ -18,6 +19,7 @@ GA::GA(KusiakLayoutEvaluator evaluator) {
   tour_size = 4;
   mut_rate = 0.05;
   cross_rate = 0.40;
+  max_evals = 1000;
   srand(time(NULL));
 }
 
@@ -29,6 +31,8 @@ GA::~GA() {
 
 void GA::evaluate() {
   double minfit = std::numeric_limits<double>::max();
+  // reused for every layout, the evaluator writes into it
+  std::vector<double> fitnesses(nt);
   for (int p=0; p<num_pop; p++) {
     int nturbines=0;
     for (int i=0; i<nt; i++) {
@@ -49,11 +53,14 @@ void GA::evaluate() {
 
     wfle.evaluate(layout);
     double coe = wfle.getEnergyCost();
-    Matrix<double>* fitnesses = wfle.getTurbineFitnesses();
+    // an invalid layout has no outputs, none of its turbines count
+    if (!wfle.copyTurbineFitnesses(fitnesses.data())) {
+      std::fill(fitnesses.begin(), fitnesses.begin()+nturbines, 0.0);
+    }
 
     int n_valid = 0;
     for (int i=0; i<nturbines; i++) {
-      if (fitnesses->get(i,0) > 0.80) {
+      if (fitnesses[i] > 0.80) {
         n_valid++;
       }
     }
@@ -63,7 +70,6 @@ void GA::evaluate() {
         minfit = fits[p];
     }
     delete layout;
-    delete fitnesses;
   }
 
   printf("%f\n", minfit);
@@ -75,10 +81,10 @@ void GA::run() {
 
   // set up grid
   // centers must be > 8*R apart
-  double interval = 8.001 * wfle.scenario.R;
+  double interval = 8.001 * wfle.getScenario().R;
 
-  int nx = (int) wfle.scenario.width / interval;
-  int ny = (int) wfle.scenario.height / interval;
+  int nx = (int) wfle.getScenario().width / interval;
+  int ny = (int) wfle.getScenario().height / interval;
 
   // get number of valid grid spots
   nt=0;
@@ -88,11 +94,11 @@ void GA::run() {
       double ypos = y*interval;
       bool valid = true;
 
-      for (unsigned int o=0; o<wfle.scenario.obstacles.rows; o++) {
-        double xmin = wfle.scenario.obstacles.get(o, 0);
-        double ymin = wfle.scenario.obstacles.get(o, 1);
-        double xmax = wfle.scenario.obstacles.get(o, 2);
-        double ymax = wfle.scenario.obstacles.get(o, 3);
+      for (unsigned int o=0; o<wfle.getScenario().obstacles.rows; o++) {
+        double xmin = wfle.getScenario().obstacles.get(o, 0);
+        double ymin = wfle.getScenario().obstacles.get(o, 1);
+        double xmax = wfle.getScenario().obstacles.get(o, 2);
+        double ymax = wfle.getScenario().obstacles.get(o, 3);
         if (xpos>xmin && ypos>ymin && xpos<xmax && ypos<ymax) {
           valid = false;
 	  }
@@ -111,11 +117,11 @@ void GA::run() {
       double ypos = y*interval;
       bool valid = true;
 
-      for (unsigned int o=0; o<wfle.scenario.obstacles.rows; o++) {
-        double xmin = wfle.scenario.obstacles.get(o, 0);
-        double ymin = wfle.scenario.obstacles.get(o, 1);
-        double xmax = wfle.scenario.obstacles.get(o, 2);
-        double ymax = wfle.scenario.obstacles.get(o, 3);
+      for (unsigned int o=0; o<wfle.getScenario().obstacles.rows; o++) {
+        double xmin = wfle.getScenario().obstacles.get(o, 0);
+        double ymin = wfle.getScenario().obstacles.get(o, 1);
+        double xmax = wfle.getScenario().obstacles.get(o, 2);
+        double ymax = wfle.getScenario().obstacles.get(o, 3);
         if (xpos>xmin && ypos>ymin && xpos<xmax && ypos<ymax) {
           valid = false;
         }
@@ -144,8 +150,9 @@ void GA::run() {
 
   // evaluate initial populations (uses num_pop evals)
   evaluate();
-  // GA
-  for (int i=0; i<(1000/num_pop); i++) {
+  // GA, as long as another generation fits into the evaluation budget
+  int start_evals = wfle.getNumberOfEvaluation() - num_pop;
+  while (wfle.getNumberOfEvaluation() - start_evals + num_pop <= max_evals) {
 
     // rank populations (tournament)
     int num_winners = num_pop/tour_size;
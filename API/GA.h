@@ -15,6 +15,7 @@ class GA {
     int tour_size;
     double mut_rate;
     double cross_rate;
+    int max_evals;
     Matrix<double>* grid;
 
     GA(KusiakLayoutEvaluator evaluator);
@@ -1,108 +1,199 @@
 #include "KusiakLayoutEvaluator.h"
+#include <algorithm>
+
+std::atomic<int> KusiakLayoutEvaluator::nApproxEvals(0);
 
 KusiakLayoutEvaluator::KusiakLayoutEvaluator() {
-  tspe=NULL;
   tpositions=NULL;
+  nTurbines=0;
+  outputsValid=false;
+  directionShare=1.0;
+  nDirections=0;
+  tiledWakes=true;
+  singlePrecision=false;
 }
 
 void KusiakLayoutEvaluator::initialize(WindScenario& sc) {
-  scenario=WindScenario(sc);
-  wakeFreeEnergy=sc.wakeFreeEnergy;
+  initialize(std::make_shared<const CompiledScenario>(sc));
+}
+
+void KusiakLayoutEvaluator::initialize(std::shared_ptr<const CompiledScenario> sc) {
+  compiled=sc;
+  wakeFreeEnergy=compiled->scenario.wakeFreeEnergy;
   energyCapture=0;
-  if (tspe) delete tspe;
-  if (tpositions) delete tpositions;
-  tspe=NULL;
   tpositions=NULL;
+  nTurbines=0;
+  outputsValid=false;
   nEvals=0;
   energyCost = std::numeric_limits<double>::max();
+  setDirectionShare(directionShare);
+}
+
+void KusiakLayoutEvaluator::setDirectionShare(double share) {
+  directionShare=share;
+  // applied by initialize
+  if (!compiled) return;
+  const std::vector<int>& directionOrder=compiled->directionOrder;
+  const std::vector<double>& directionFreeEnergy=compiled->directionFreeEnergy;
+  if (share>=1.0) {
+    nDirections=directionOrder.size();
+    return;
+  }
+  double total=0;
+  for (double e : directionFreeEnergy) total+=e;
+  double covered=0;
+  nDirections=0;
+  while (nDirections<(int)directionOrder.size() && (nDirections==0 || covered<share*total)) {
+    covered+=directionFreeEnergy[directionOrder[nDirections]];
+    nDirections++;
+  }
 }
 
 KusiakLayoutEvaluator::~KusiakLayoutEvaluator() {
-  if (tspe) delete tspe;
-  if (tpositions) delete tpositions;
 }
 
 double KusiakLayoutEvaluator::evaluate(Matrix<double>* layout) {
-  static double ct  = 750000;
-  static double cs  = 8000000;
-  static double m   = 30;
-  static double r   = 0.03;
-  static double y   = 20;
-  static double com = 20000;
-  
+  energyCostLower = std::numeric_limits<double>::max();
+  energyCostUpper = std::numeric_limits<double>::max();
   double wfr = evaluate_2014(layout);
   if (wfr <= 0) return std::numeric_limits<double>::max();
   int n = layout->rows;
   
-  energyCost = (((ct*n+cs*std::floor(n/m))*(0.666667+0.333333*std::exp(-0.00174*n*n))+com*n)/
-	  ((1.0-std::pow(1.0+r, -y))/r)/(8760.0*scenario.wakeFreeEnergy*wfr*n))+0.1/n;
+  energyCost = costOfEnergy(n, wfr);
+  energyCostLower = costOfEnergy(n, wakeFreeRatioUpper);
+  energyCostUpper = costOfEnergy(n, wakeFreeRatioLower);
   return energyCost;
 }
 
+double KusiakLayoutEvaluator::costOfEnergy(int n, double wfr) {
+  return compiled->costOfEnergy(n, wfr);
+}
+
 double KusiakLayoutEvaluator::evaluate_2014(Matrix<double>* layout) {
-  nEvals++;
-  if (tpositions) delete tpositions;
-  tpositions=new Matrix<double>(layout);
-  if (tspe) delete tspe;
+  const WindScenario& scenario=compiled->scenario;
+  const std::vector<int>& directionOrder=compiled->directionOrder;
+  const std::vector<double>& directionFreeEnergy=compiled->directionFreeEnergy;
+  if (nDirections<(int)directionOrder.size() || singlePrecision) {
+    nApproxEvals++;
+  } else {
+    nEvals++;
+  }
+  // the layout is only read during the evaluation, so it isn't copied
+  tpositions=layout;
+  nTurbines=layout->rows;
+  outputsValid=false;
   energyCapture=0;
   wakeFreeRatio=0;
+  wakeFreeRatioLower=0;
+  wakeFreeRatioUpper=0;
   if (checkConstraint()) {
-    tspe=new Matrix<double>(scenario.thetas.rows, tpositions->rows);
-    // Wind resource per turbine => stored temporaly in tspe
-    for (int turb=0; turb<tpositions->rows; turb++) {
-      // for each turbine
+    // keeps its capacity, so this only allocates for a larger layout
+    energyOutputs.resize(scenario.thetas.rows*nTurbines);
+    // the wake free energy of the directions which are evaluated and skipped
+    std::vector<bool> evaluated(scenario.thetas.rows, false);
+    double evaluatedFree=0;
+    double skippedFree=0;
+    for (int d=0; d<(int)directionOrder.size(); d++) {
+      evaluated[directionOrder[d]]=d<nDirections;
+      (d<nDirections ? evaluatedFree : skippedFree)+=directionFreeEnergy[directionOrder[d]];
+    }
+    if (tiledWakes) {
+      std::vector<int> directions;
       for (int thets=0; thets<scenario.thetas.rows; thets++) {
-	// for each direction
-	// double theta=(scenario.thetas.get(thets, 0)+scenario.thetas.get(thets, 1))/2.0;
-	// calculate wake
-	// double totalVdef=calculateWakeTurbine(turb, theta);
-	double totalVdef=calculateWakeTurbine(turb, thets);
-	double cTurb=scenario.c.get(0,thets)*(1.0-totalVdef);
-	// annual power output per turbine and per direction
-	double tint=scenario.thetas.get(thets, 1)-scenario.thetas.get(thets, 0);
-	double w=scenario.omegas.get(0, thets);
-	double ki=scenario.ks.get(0, thets);
-	double totalPow=0;
-	for (int ghh=1; ghh<scenario.vints.cols; ghh++) {
-	  double v=(scenario.vints.get(0, ghh)+scenario.vints.get(0, ghh-1))/2.0;
-	  double P=powOutput(v);
-	  double prV=wblcdf(scenario.vints.get(0, ghh), cTurb, ki)-wblcdf(scenario.vints.get(0, ghh-1),cTurb,ki);
-	  totalPow+=prV*P;
+	if (evaluated[thets]) directions.push_back(thets);
+      }
+      if (singlePrecision) {
+	calculateWakesTiled(directions, floatWorkspace);
+      } else {
+	calculateWakesTiled(directions, doubleWorkspace);
+      }
+    }
+    // Wind resource per turbine => stored temporaly in tspe
+    // each task computes the outputs of a block of turbines
+    static const int TURBINES_PER_TASK=256;
+    int tasks=(nTurbines+TURBINES_PER_TASK-1)/TURBINES_PER_TASK;
+    runTasks(tasks, [&](int task) {
+      int end=std::min(nTurbines, (task+1)*TURBINES_PER_TASK);
+      for (int turb=task*TURBINES_PER_TASK; turb<end; turb++) {
+	// for each turbine
+	double turbineCapture=0;
+	for (int thets=0; thets<scenario.thetas.rows; thets++) {
+	  // for each direction
+	  if (!evaluated[thets]) continue;
+	  // double theta=(scenario.thetas.get(thets, 0)+scenario.thetas.get(thets, 1))/2.0;
+	  // calculate wake
+	  // double totalVdef=calculateWakeTurbine(turb, theta);
+	  double totalVdef=tiledWakes ? wakes[thets*nTurbines+turb] : calculateWakeTurbine(turb, thets);
+	  double cTurb=scenario.c.get(0,thets)*(1.0-totalVdef);
+	  // annual power output per turbine and per direction
+	  double totalPow=singlePrecision ? compiled->directionPower<float>(thets, cTurb) :
+	    compiled->directionPower<double>(thets, cTurb);
+	  energyOutputs[thets*nTurbines+turb]=totalPow;
+	  turbineCapture+=totalPow;
 	}
-	totalPow+=scenario.PRated*(1.0-wblcdf(scenario.vRated, cTurb, ki));
-	totalPow*=tint*w;
-	tspe->set(thets, turb, totalPow);
-	energyCapture+=totalPow;
+	// the skipped directions get the wake free ratio of the evaluated ones
+	for (int thets=0; thets<scenario.thetas.rows; thets++) {
+	  if (evaluated[thets]) continue;
+	  energyOutputs[thets*nTurbines+turb]=directionFreeEnergy[thets]*turbineCapture/evaluatedFree;
+	}
+      }
+    });
+    // summed in the order of a single task, so the total doesn't depend on
+    // how the tasks were run
+    for (int turb=0; turb<nTurbines; turb++) {
+      for (int thets=0; thets<scenario.thetas.rows; thets++) {
+	if (evaluated[thets]) energyCapture+=energyOutputs[thets*nTurbines+turb];
       }
     }
+    // a wake never increases the energy, so a skipped direction
+    // contributes between nothing and its wake free energy
+    double n=tpositions->rows;
+    wakeFreeRatioLower=energyCapture/(wakeFreeEnergy*n);
+    wakeFreeRatioUpper=(energyCapture+skippedFree*n)/(wakeFreeEnergy*n);
+    energyCapture*=(evaluatedFree+skippedFree)/evaluatedFree;
     wakeFreeRatio=energyCapture/(wakeFreeEnergy*tpositions->rows);
+    outputsValid=true;
+    tpositions=NULL;
     return wakeFreeRatio;
   } else {
+    tpositions=NULL;
     return 0;
   }
 }
 
 Matrix<double>* KusiakLayoutEvaluator::getEnergyOutputs() {
-  if (!tspe) return NULL;
-  Matrix<double>* res = new Matrix<double>(tspe);
+  if (!outputsValid) return NULL;
+  Matrix<double>* res = new Matrix<double>(compiled->scenario.thetas.rows, nTurbines, energyOutputs.data());
   return res;
 }
 
 Matrix<double>* KusiakLayoutEvaluator::getTurbineFitnesses() {
-  if (!tspe) return NULL;
-  Matrix<double>* res = new Matrix<double>(tpositions->rows, 1);
-  for (int i=0; i<res->rows; i++) {
+  if (!outputsValid) return NULL;
+  Matrix<double>* res = new Matrix<double>(nTurbines, 1);
+  copyTurbineFitnesses(&(*res)(0, 0));
+  return res;
+}
+
+bool KusiakLayoutEvaluator::copyEnergyOutputs(double* out) {
+  if (!outputsValid) return false;
+  std::copy(energyOutputs.begin(), energyOutputs.begin()+compiled->scenario.thetas.rows*nTurbines, out);
+  return true;
+}
+
+bool KusiakLayoutEvaluator::copyTurbineFitnesses(double* out) {
+  if (!outputsValid) return false;
+  for (int i=0; i<nTurbines; i++) {
     double val=0.0;
-    for (int j=0; j<tspe->rows; j++) {
-      val+=tspe->get(j,i);
+    for (int j=0; j<compiled->scenario.thetas.rows; j++) {
+      val+=energyOutputs[j*nTurbines+i];
     }
-    res->set(i,0,val/scenario.wakeFreeEnergy);
+    out[i]=val/wakeFreeEnergy;
   }
-  return res;
+  return true;
 }
 
-
 double KusiakLayoutEvaluator::powOutput(double v) {
+  const WindScenario& scenario=compiled->scenario;
   if (v<scenario.vCin) {
     return 0;
   } else if (v>=scenario.vCin && v<=scenario.vRated) {
@@ -117,7 +208,7 @@ double KusiakLayoutEvaluator::powOutput(double v) {
 double KusiakLayoutEvaluator::calculateWakeTurbine(int turb, double theta) {
   double x=tpositions->get(turb, 0);
   double y=tpositions->get(turb, 1);
-  static const double alpha=atan(scenario.k);
+  const double alpha=compiled->cone.alpha;
   double velDef=0;
   for (int oturb=0; oturb<tpositions->rows; oturb++) {
     if (oturb!=turb) {
@@ -137,7 +228,7 @@ double KusiakLayoutEvaluator::calculateWakeTurbine(int turb, double theta) {
 double KusiakLayoutEvaluator::calculateWakeTurbine(int turb, int thetIndex) {
   double x=tpositions->get(turb, 0);
   double y=tpositions->get(turb, 1);
-  static const double alpha=atan(scenario.k);
+  const double alpha=compiled->cone.alpha;
   double velDef=0;
   for (int oturb=0; oturb<tpositions->rows; oturb++) {
     if (oturb!=turb) {
@@ -154,10 +245,155 @@ double KusiakLayoutEvaluator::calculateWakeTurbine(int turb, int thetIndex) {
   return sqrt(velDef);
 }
 
+template <typename T>
+void KusiakLayoutEvaluator::calculateWakesTiled(const std::vector<int>& directions, TiledWorkspace<T>& workspace) {
+  if (directions.size()==SCENARIO_DIRECTIONS) {
+    tiledWakeKernel<T, SCENARIO_DIRECTIONS>(directions, workspace);
+  } else {
+    tiledWakeKernel<T, 0>(directions, workspace);
+  }
+}
+
+// DIRECTIONS is the number of directions if it is known at compile time,
+// so that the loops over them are unrolled, and 0 otherwise
+template <typename T, int DIRECTIONS>
+void KusiakLayoutEvaluator::tiledWakeKernel(const std::vector<int>& directions, TiledWorkspace<T>& workspace) {
+  // the blocks of targets and sources: the squared deficits of a target
+  // block (TARGETS x directions) and the positions of a source block fit
+  // into the L1 cache together
+  static const int TARGETS=64;
+  static const int SOURCES=512;
+  // beta<alpha is decided on num/denom>cos(alpha), squared, where it isn't
+  // close; pairs near the border of the cone, or on its axis where the
+  // acos of calculateBeta can be nan, are decided by calculateBeta
+  const T MARGIN=std::max(T(1e-9), 16*std::numeric_limits<T>::epsilon());
+  const WindScenario& scenario=compiled->scenario;
+  const double alpha=compiled->cone.alpha;
+  const double cosAlpha=compiled->cone.cosAlpha;
+  const T inner=(cosAlpha+MARGIN)*(cosAlpha+MARGIN);
+  const T outer=(cosAlpha-MARGIN)*(cosAlpha-MARGIN);
+  const T axis=(1.0-MARGIN)*(1.0-MARGIN);
+  // decided like calculateWakeTurbine, on the exact positions
+  auto shadows=[&](int t, int s, int d) {
+    return calculateBeta(tpositions->get(t, 0), tpositions->get(t, 1), tpositions->get(s, 0),
+			 tpositions->get(s, 1), directions[d])<alpha;
+  };
+  // computing the deficits of all directions, so that they are vectorized,
+  // only pays off with four floats per SSE register; with two doubles it
+  // is faster to skip the directions in which the source doesn't shadow
+  const bool VECTORIZED=sizeof(T)<sizeof(double);
+  const T rk=compiled->cone.rkRatio;
+  const T a=compiled->cone.velocityDeficit;
+  const T kr=compiled->cone.krRatio;
+  int n=nTurbines;
+  const int nd=DIRECTIONS>0 ? DIRECTIONS : directions.size();
+  std::vector<T>& xs=workspace.xs;
+  std::vector<T>& ys=workspace.ys;
+  xs.resize(n);
+  ys.resize(n);
+  for (int i=0; i<n; i++) {
+    xs[i]=tpositions->get(i, 0);
+    ys[i]=tpositions->get(i, 1);
+  }
+  // the constants of each direction: cos, sin, rk*cos and rk*sin
+  std::vector<T> constants(4*nd);
+  for (int d=0; d<nd; d++) {
+    constants[d]=scenario.getCosMidThetas(directions[d]);
+    constants[nd+d]=scenario.getSinMidThetas(directions[d]);
+    constants[2*nd+d]=rk*constants[d];
+    constants[3*nd+d]=rk*constants[nd+d];
+  }
+  wakes.resize(scenario.thetas.rows*n);
+  workspace.sums.resize(n*nd);
+  // one task per target block, the blocks write disjoint sums and wakes
+  runTasks((n+TARGETS-1)/TARGETS, [&](int block) {
+    int t0=block*TARGETS;
+    int t1=std::min(n, t0+TARGETS);
+    T* sums=&workspace.sums[t0*nd];
+    std::fill(sums, sums+(t1-t0)*nd, T(0));
+    // with a fixed count, the constants and the sums of a target are
+    // copied into arrays of the task, which the compiler knows not to alias
+    const int SLOTS=DIRECTIONS>0 ? DIRECTIONS : 1;
+    T fixedConstants[4*SLOTS];
+    T fixedSum[SLOTS];
+    if (DIRECTIONS>0) std::copy(constants.begin(), constants.end(), fixedConstants);
+    const T* cosT=DIRECTIONS>0 ? fixedConstants : constants.data();
+    const T* sinT=cosT+nd;
+    const T* rkCos=cosT+2*nd;
+    const T* rkSin=cosT+3*nd;
+    // the sources are visited in the same order as by calculateWakeTurbine,
+    // so in double the sums are bit for bit the same
+    for (int s0=0; s0<n; s0+=SOURCES) {
+      int s1=std::min(n, s0+SOURCES);
+      for (int t=t0; t<t1; t++) {
+	T x=xs[t];
+	T y=ys[t];
+	T* sum=DIRECTIONS>0 ? fixedSum : &sums[(t-t0)*nd];
+	if (DIRECTIONS>0) std::copy(&sums[(t-t0)*nd], &sums[(t-t0+1)*nd], sum);
+	for (int s=s0; s<s1; s++) {
+	  if (s==t) continue;
+	  T dx=x-xs[s];
+	  T dy=y-ys[s];
+	  if (!VECTORIZED) {
+	    for (int d=0; d<nd; d++) {
+	      T num=(dx*cosT[d]+dy*sinT[d]+rk);
+	      // beta is at least pi/2 behind the apex of the cone
+	      if (num<=0) continue;
+	      T ca=dx+rkCos[d];
+	      T cb=dy+rkSin[d];
+	      T denom2=ca*ca+cb*cb;
+	      if (num*num<outer*denom2) continue;
+	      if ((num*num<inner*denom2 || num*num>axis*denom2) && !shadows(t, s, d)) continue;
+	      T dij=std::abs(dx*cosT[d]+dy*sinT[d]);
+	      T curDef=a/((T(1.0)+kr*dij)*(T(1.0)+kr*dij));
+	      sum[d]+=curDef*curDef;
+	    }
+	    continue;
+	  }
+	  // the directions are handled without branches; a deficit times 1
+	  // or 0 is exact, and adding 0 leaves a sum unchanged
+	  int border=0;
+	  for (int d=0; d<nd; d++) {
+	    T num=(dx*cosT[d]+dy*sinT[d]+rk);
+	    T ca=dx+rkCos[d];
+	    T cb=dy+rkSin[d];
+	    T denom2=ca*ca+cb*cb;
+	    int ahead=num>0;
+	    int inside=ahead & (num*num>=inner*denom2) & (num*num<=axis*denom2);
+	    border|=ahead & (num*num>=outer*denom2) & (inside^1);
+	    T dij=std::abs(dx*cosT[d]+dy*sinT[d]);
+	    T curDef=a/((T(1.0)+kr*dij)*(T(1.0)+kr*dij));
+	    sum[d]+=curDef*curDef*T(inside);
+	  }
+	  if (!border) continue;
+	  // rare: the directions near the border of the cone
+	  for (int d=0; d<nd; d++) {
+	    T num=(dx*cosT[d]+dy*sinT[d]+rk);
+	    T ca=dx+rkCos[d];
+	    T cb=dy+rkSin[d];
+	    T denom2=ca*ca+cb*cb;
+	    if (!(num>0) || num*num<outer*denom2 ||
+		(num*num>=inner*denom2 && num*num<=axis*denom2) || !shadows(t, s, d)) continue;
+	    T dij=std::abs(dx*cosT[d]+dy*sinT[d]);
+	    T curDef=a/((T(1.0)+kr*dij)*(T(1.0)+kr*dij));
+	    sum[d]+=curDef*curDef;
+	  }
+	}
+	if (DIRECTIONS>0) std::copy(sum, sum+nd, &sums[(t-t0)*nd]);
+      }
+    }
+    for (int t=t0; t<t1; t++) {
+      for (int d=0; d<nd; d++) {
+	wakes[directions[d]*n+t]=std::sqrt(sums[(t-t0)*nd+d]);
+      }
+    }
+  });
+}
+
 double KusiakLayoutEvaluator::calculateVelocityDeficit(double dij) {
-  static const double a=1.0-sqrt(1.0-scenario.CT);
-  static const double rkRatio=scenario.k/scenario.R;
-  return a/((1.0+rkRatio*dij)*(1.0+rkRatio*dij));
+  const double a=compiled->cone.velocityDeficit;
+  const double krRatio=compiled->cone.krRatio;
+  return a/((1.0+krRatio*dij)*(1.0+krRatio*dij));
 }
 
 double KusiakLayoutEvaluator::calculateProjectedDistance(double xi, double yi, double xj, double yj, double theta) {
@@ -166,13 +402,14 @@ double KusiakLayoutEvaluator::calculateProjectedDistance(double xi, double yi, d
 }
 
 double KusiakLayoutEvaluator::calculateProjectedDistance(double xi, double yi, double xj, double yj, int thetIndex) {
+  const WindScenario& scenario=compiled->scenario;
   return abs((xi-xj)*scenario.getCosMidThetas(thetIndex)+(yi-yj)*scenario.getSinMidThetas(thetIndex));
 }
 
 // calculate the angle between to turbines using xi, xj, yi, yj, R, k and theta
 double KusiakLayoutEvaluator::calculateBeta(double xi, double yi, double xj, double yj, double theta) {
   static const double fac=M_PI/180.0;
-  static const double rkRatio=scenario.R/scenario.k;
+  const double rkRatio=compiled->cone.rkRatio;
   double num=((xi-xj)*cos(fac*theta)+(yi-yj)*sin(fac*theta)+rkRatio);
   double a=xi-xj+rkRatio*cos(fac*theta);
   double b=yi-yj+rkRatio*sin(fac*theta);
@@ -181,47 +418,74 @@ double KusiakLayoutEvaluator::calculateBeta(double xi, double yi, double xj, dou
 }
 
 double KusiakLayoutEvaluator::calculateBeta(double xi, double yi, double xj, double yj, int thetIndex) {
-  static const double rkRatio=scenario.R/scenario.k;
-  double num=((xi-xj)*scenario.getCosMidThetas(thetIndex)+(yi-yj)*scenario.getSinMidThetas(thetIndex)+rkRatio);
-  double a=xi-xj+rkRatio*scenario.getCosMidThetas(thetIndex);
-  double b=yi-yj+rkRatio*scenario.getSinMidThetas(thetIndex);
+  const WindScenario& scenario=compiled->scenario;
+  double num=((xi-xj)*scenario.getCosMidThetas(thetIndex)+(yi-yj)*scenario.getSinMidThetas(thetIndex)+compiled->cone.rkRatio);
+  double a=xi-xj+compiled->rkCos[thetIndex];
+  double b=yi-yj+compiled->rkSin[thetIndex];
   double denom=sqrt(a*a+b*b);
   return acos(num/denom);
 }
 
+void KusiakLayoutEvaluator::runTasks(int count, const std::function<void(int)>& body) {
+  if (parallelFor && count>1) {
+    parallelFor(count, body);
+  } else {
+    for (int i=0; i<count; i++) body(i);
+  }
+}
+
 bool KusiakLayoutEvaluator::checkConstraint() {
-  static const double minDist=64.0*scenario.R*scenario.R;
-  for (int i=0; i<tpositions->rows; i++) {
-    // check boundaries
-    if (tpositions->get(i, 0) < 0 || tpositions->get(i, 0) > scenario.width ||
-        tpositions->get(i, 1) < 0 || tpositions->get(i, 1) > scenario.height) {
-      return false;
-    }
-    // check for obstacles
-    for (int j=0; j<scenario.obstacles.rows; j++) {
-      if (tpositions->get(i, 0) > scenario.obstacles.get(j, 0) &&
-	  tpositions->get(i, 0) < scenario.obstacles.get(j, 2) &&
-	  tpositions->get(i, 1) > scenario.obstacles.get(j, 1) &&
-	  tpositions->get(i, 1) < scenario.obstacles.get(j, 3)) {
-	printf("Obstacle %d [%f, %f, %f, %f] violated by turbine %d (%f, %f)\n", 
-	       j, scenario.obstacles.get(j, 0), scenario.obstacles.get(j, 1),
-	       scenario.obstacles.get(j, 2), scenario.obstacles.get(j, 3), i);
-	return false;
+  static const int TURBINES_PER_TASK=256;
+  int n=tpositions->rows;
+  // the first turbine found to violate a constraint; a block is skipped
+  // once a violation before it is known, so this ends up as the first
+  // violation of the layout however the blocks are run
+  std::atomic<int> first(n);
+  runTasks((n+TURBINES_PER_TASK-1)/TURBINES_PER_TASK, [&](int task) {
+    int end=std::min(n, (task+1)*TURBINES_PER_TASK);
+    for (int i=task*TURBINES_PER_TASK; i<end && i<first; i++) {
+      if (violatesConstraint(i, false)) {
+	int known=first;
+	while (i<known && !first.compare_exchange_weak(known, i));
+	return;
       }
     }
-    // checking security distance constraint
-    for (int j=0; j<tpositions->rows; j++) {
-      if (i!=j) {
-	// calculate the sqared distance between both turbs
-	double dist=(tpositions->get(i, 0)-tpositions->get(j, 0))*(tpositions->get(i, 0)-tpositions->get(j, 0))+
-	  (tpositions->get(i, 1)-tpositions->get(j, 1))*(tpositions->get(i, 1)-tpositions->get(j, 1));
-	if (dist<minDist) {
-          //printf("dist:\t%f\t<\t%f\t(%d,%d)\n",dist,minDist,i,j);
-	  return false;
-	}
+  });
+  if (first==n) return true;
+  violatesConstraint(first, true);
+  return false;
+}
+
+bool KusiakLayoutEvaluator::violatesConstraint(int i, bool report) {
+  const WindScenario& scenario=compiled->scenario;
+  const double minDist=compiled->minDistanceSquared;
+  // check boundaries
+  if (tpositions->get(i, 0) < 0 || tpositions->get(i, 0) > scenario.width ||
+      tpositions->get(i, 1) < 0 || tpositions->get(i, 1) > scenario.height) {
+    return true;
+  }
+  // check for obstacles, only those in the cell of the index
+  int j=compiled->obstacleAt(tpositions->get(i, 0), tpositions->get(i, 1));
+  if (j>=0) {
+    if (report) {
+      printf("Obstacle %d [%f, %f, %f, %f] violated by turbine %d (%f, %f)\n", 
+	     j, scenario.obstacles.get(j, 0), scenario.obstacles.get(j, 1),
+	     scenario.obstacles.get(j, 2), scenario.obstacles.get(j, 3), i);
+    }
+    return true;
+  }
+  // checking security distance constraint
+  for (int j=0; j<tpositions->rows; j++) {
+    if (i!=j) {
+      // calculate the sqared distance between both turbs
+      double dist=(tpositions->get(i, 0)-tpositions->get(j, 0))*(tpositions->get(i, 0)-tpositions->get(j, 0))+
+	(tpositions->get(i, 1)-tpositions->get(j, 1))*(tpositions->get(i, 1)-tpositions->get(j, 1));
+      if (dist<minDist) {
+        //printf("dist:\t%f\t<\t%f\t(%d,%d)\n",dist,minDist,i,j);
+	return true;
       }
     }
   }
-  return true;
+  return false;
 }
 
@@ -3,8 +3,13 @@
 
 #include "WindFarmLayoutEvaluator.h"
 #include "WindScenario.h"
+#include "CompiledScenario.h"
 #include "Matrix.hpp"
+#include <cmath>
+#include <functional>
 #include <limits>
+#include <memory>
+#include <vector>
 
 class KusiakLayoutEvaluator : public WindFarmLayoutEvaluator {
   public:
@@ -12,26 +17,145 @@ class KusiakLayoutEvaluator : public WindFarmLayoutEvaluator {
     virtual ~KusiakLayoutEvaluator();
 
     virtual void initialize(WindScenario& scenario);
+    /**
+     * Initializes the evaluator with a compiled scenario, which it shares
+     * with the other evaluators of the scenario instead of copying it.
+     * @param compiled The compiled scenario
+     */
+    void initialize(std::shared_ptr<const CompiledScenario> compiled);
 
     virtual double evaluate(Matrix<double>* layout);
     virtual double evaluate_2014(Matrix<double>* layout);
 
     virtual Matrix<double>* getEnergyOutputs();
     virtual Matrix<double>* getTurbineFitnesses();
+    virtual bool copyEnergyOutputs(double* out);
+    virtual bool copyTurbineFitnesses(double* out);
     virtual double getEnergyOutput() {return energyCapture;};
     virtual double getWakeFreeRatio() {return wakeFreeRatio;};
     virtual double getEnergyCost() {return energyCost;};
-    WindScenario scenario;
+
+    /**
+     * Switches to an approximate evaluation which only computes the wakes
+     * of the directions with the most wake free energy, until they cover
+     * the given share of it (1.0, the default, evaluates all directions).
+     * The skipped directions are assumed to have the same wake free ratio
+     * as the evaluated ones; since a wake can only lower the energy of a
+     * turbine, the exact result lies within the bounds below.
+     * Approximate evaluations don't increase the number of evaluations
+     * counter, they are counted by getNumberOfApproximateEvaluation.
+     * @param share The share of the wake free energy in (0, 1]
+     */
+    void setDirectionShare(double share);
+    double getDirectionShare() {return directionShare;};
+    int getEvaluatedDirections() {return nDirections;};
+
+    /**
+     * Selects how the wakes are computed: the tiled kernel (the default)
+     * processes blocks of source turbines against blocks of target turbines
+     * for all directions at once, so both blocks stay in the cache and the
+     * offsets of a pair of turbines are computed once instead of once per
+     * direction. Otherwise calculateWakeTurbine streams the whole layout
+     * for every turbine and direction. Both give the same results.
+     * @param tiled True for the tiled kernel
+     */
+    void setTiledWakes(bool tiled) {tiledWakes=tiled;};
+    bool getTiledWakes() {return tiledWakes;};
+
+    /**
+     * Splits a single evaluation into tasks over blocks of turbines. The
+     * hook is called with the number of tasks and their body; it has to run
+     * body(i) once for every i in [0, count), on any threads and in any
+     * order, and return when all of them have finished. Each task writes
+     * its own part of the results and the sums over the turbines are taken
+     * afterwards in a fixed order, so the results are the same as without
+     * a hook (the default), which runs the tasks in order.
+     * @param hook The hook, or an empty function to run serially
+     */
+    typedef std::function<void(int, const std::function<void(int)>&)> ParallelFor;
+    void setParallelFor(const ParallelFor& hook) {parallelFor=hook;};
+
+    /**
+     * Switches to an approximate evaluation which computes the wakes of the
+     * tiled kernel and the power curve in float instead of double, for
+     * ranking layouts during the search; the final candidates should be
+     * evaluated again in double. It is counted like an approximate
+     * evaluation, and the cost bounds above only account for the skipped
+     * directions, not for the rounding. Pairs of turbines near the border
+     * of a wake are still decided in double; on the layouts of the
+     * benchmark the cost of energy is within 2e-8 relative of the double
+     * one on every scenario in Scenarios/.
+     * @param single True for single precision
+     */
+    void setSinglePrecision(bool single) {singlePrecision=single;};
+    bool getSinglePrecision() {return singlePrecision;};
+
+    /**
+     * Bounds of the exact wake free ratio and energy cost of the last
+     * layout evaluated; equal to the returned values if no direction was
+     * skipped.
+     */
+    double getWakeFreeRatioLowerBound() {return wakeFreeRatioLower;};
+    double getWakeFreeRatioUpperBound() {return wakeFreeRatioUpper;};
+    double getEnergyCostLowerBound() {return energyCostLower;};
+    double getEnergyCostUpperBound() {return energyCostUpper;};
+
+    /**
+     * Returns the global number of approximate evaluations.
+     */
+    static int getNumberOfApproximateEvaluation() {return nApproxEvals;};
+    const WindScenario& getScenario() const {return compiled->scenario;};
+    std::shared_ptr<const CompiledScenario> getCompiledScenario() const {return compiled;};
 
  protected:
-    Matrix<double>* tspe;
+    std::shared_ptr<const CompiledScenario> compiled;
+    // the layout, only set during the evaluation
     Matrix<double>* tpositions;
+    // the energy per direction (row) and turbine (column) of the last layout
+    // evaluated, valid if outputsValid; the buffer is reused
+    std::vector<double> energyOutputs;
+    int nTurbines;
+    bool outputsValid;
     double energyCapture;
     double wakeFreeEnergy;
     double wakeFreeRatio;
     double energyCost;
 
+    double directionShare;
+    int nDirections;
+    double wakeFreeRatioLower;
+    double wakeFreeRatioUpper;
+    double energyCostLower;
+    double energyCostUpper;
+    static std::atomic<int> nApproxEvals;
+    // the result of the tiled wake kernel, the total velocity deficit per
+    // direction (row) and turbine (column)
+    bool tiledWakes;
+    std::vector<double> wakes;
+    // the copy of the layout and the squared deficits of the target blocks
+    // of the tiled kernel, in the precision it runs in
+    template <typename T>
+    struct TiledWorkspace {
+      std::vector<T> xs;
+      std::vector<T> ys;
+      std::vector<T> sums;
+    };
+    TiledWorkspace<double> doubleWorkspace;
+    TiledWorkspace<float> floatWorkspace;
+    // the number of directions generateScenario sets up, which the tiled
+    // kernel is compiled for; other counts run the generic kernel
+    static const int SCENARIO_DIRECTIONS=24;
+    bool singlePrecision;
+    ParallelFor parallelFor;
+
+    void runTasks(int count, const std::function<void(int)>& body);
     bool checkConstraint();
+    bool violatesConstraint(int turb, bool report);
+    double costOfEnergy(int n, double wfr);
+    template <typename T>
+    void calculateWakesTiled(const std::vector<int>& directions, TiledWorkspace<T>& workspace);
+    template <typename T, int DIRECTIONS>
+    void tiledWakeKernel(const std::vector<int>& directions, TiledWorkspace<T>& workspace);
     double calculateWakeTurbine(int index, double theta);
     double calculateWakeTurbine(int index, int thetindex);
     double calculateBeta(double xi, double yi, double xj, double yj, double theta);
@@ -41,21 +165,6 @@ class KusiakLayoutEvaluator : public WindFarmLayoutEvaluator {
     double calculateProjectedDistance(double xi, double yi, double xj, double yj, int thetIndex);
     double powOutput(double v);
 
-    inline double wblcdf(double x, double sc=1.0, double sh=1.0) {return 1.0-exp(-fastPow(x/sc,sh));};
-
-    // faster because b is usually equal to 2!
-    inline static double fastPow(double a, double b) {
-        if (abs(b-2)<0.0001) {
-            return a*a;
-        } if (abs(b-1)<0.0001) {
-            return a;
-        } if (abs(b)<0.0001) {
-            return 1;
-        } else {
-            return pow(a,b);
-        }
-    }
-
 };
 
 #endif /* defined(__KUSIAK_LAYOUT_EVALUATOR_H__) */
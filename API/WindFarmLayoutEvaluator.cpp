@@ -1,4 +1,25 @@
 #include "WindFarmLayoutEvaluator.h"
 
-int WindFarmLayoutEvaluator::nEvals=0;
+std::atomic<int> WindFarmLayoutEvaluator::nEvals(0);
 
+bool WindFarmLayoutEvaluator::copyEnergyOutputs(double* out) {
+  Matrix<double>* outputs=getEnergyOutputs();
+  if (!outputs) return false;
+  for (unsigned int i=0; i<outputs->rows; i++) {
+    for (unsigned int j=0; j<outputs->cols; j++) {
+      *out++=outputs->get(i, j);
+    }
+  }
+  delete outputs;
+  return true;
+}
+
+bool WindFarmLayoutEvaluator::copyTurbineFitnesses(double* out) {
+  Matrix<double>* fitnesses=getTurbineFitnesses();
+  if (!fitnesses) return false;
+  for (unsigned int i=0; i<fitnesses->rows; i++) {
+    out[i]=fitnesses->get(i, 0);
+  }
+  delete fitnesses;
+  return true;
+}
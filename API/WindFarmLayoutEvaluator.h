@@ -3,6 +3,7 @@
 
 #include "Matrix.hpp"
 #include "WindScenario.h"
+#include <atomic>
 
 /**
  * The class WindFarmLayoutEvaluator is an interface to easily exchange the
@@ -68,6 +69,19 @@ class WindFarmLayoutEvaluator {
 	 */
     virtual Matrix<double>* getTurbineFitnesses()=0;
 
+        /**
+         * The same as getEnergyOutputs and getTurbineFitnesses, but the
+         * values are written into a buffer of the caller instead of a new
+         * matrix: direction by direction for the energy outputs (number of
+         * directions * number of turbines values), one value per turbine for
+         * the fitnesses. Evaluators which keep their outputs override these
+         * so that no memory is allocated.
+         * This method doesn't increase the number of evaluation counter.
+         * @return false if no layout has been evaluated
+         */
+    virtual bool copyEnergyOutputs(double* out);
+    virtual bool copyTurbineFitnesses(double* out);
+
     /**
 	 * Returns the global energy output of the last layout evaluated.
 	 * A layout must have been evaluated before this method is called.
@@ -95,11 +109,13 @@ class WindFarmLayoutEvaluator {
  
     /**
      * Returns the global number of time the evaluation function has been called.
+     * The counter is shared by all evaluators and may be increased by
+     * evaluators running on different threads.
      */
   int getNumberOfEvaluation() {return nEvals;};
  
  protected:
-  static int nEvals;
+  static std::atomic<int> nEvals;
 };
 
 #endif /* defined(__WIND_FARM_LAYOUT_EVALUATOR_H__) */
@@ -53,6 +53,8 @@ nturbines(wsc.nturbines),
 coSinMidThetas(wsc.coSinMidThetas),
 rkRatio(wsc.rkRatio),
 vints(wsc.vints),
+binPower(wsc.binPower),
+directionWeights(wsc.directionWeights),
 wblcdfAccuracy(wsc.wblcdfAccuracy),
 cMax(wsc.cMax),
 cMin(wsc.cMin),
@@ -138,5 +140,20 @@ void WindScenario::initOptimizationParameters() {
     for (double i=0; i<vints.cols; i++) {
       vints.set(0,i,3.5+i*0.5);
     }
+    binPower.resize(vints.cols-1);
+    for (int ghh=1; ghh<vints.cols; ghh++) {
+      double v=(vints.get(0, ghh)+vints.get(0, ghh-1))/2.0;
+      double P=0;
+      if (v>=vCin && v<=vRated) {
+        P=lambda*v+eta;
+      } else if (vCout>v && v>vRated) {
+        P=PRated;
+      }
+      binPower[ghh-1]=P;
+    }
+    directionWeights.resize(thetas.rows);
+    for (int thets=0; thets<thetas.rows; thets++) {
+      directionWeights[thets]=(thetas.get(thets, 1)-thetas.get(thets, 0))*omegas.get(0, thets);
+    }
 }
 
@@ -59,12 +59,17 @@ public:
     static double fac;
     void initOptimizationParameters();
     Matrix<double> coSinMidThetas;
-    inline double getCosMidThetas(int thetIndex) {
+    inline double getCosMidThetas(int thetIndex) const {
       return coSinMidThetas.get(thetIndex, 0);};
-    inline double getSinMidThetas(int thetIndex) {
+    inline double getSinMidThetas(int thetIndex) const {
       return coSinMidThetas.get(thetIndex, 1);};
     double rkRatio;
     Matrix<double> vints;
+    // power curve at the middle of each speed bin [vints(i), vints(i+1)],
+    // so the energy of a turbine is a dot product with the bin probabilities
+    vector<double> binPower;
+    // width times frequency of each direction
+    vector<double> directionWeights;
     vector<double> wblcdfValues;
     double wblcdfAccuracy;
     double cMax, cMin;
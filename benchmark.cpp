@@ -0,0 +1,210 @@
+/*  benchmark.cpp
+ *
+ *   Measures the latency and the heap allocations of the hot operators.
+ *   usage: benchmark <scenario.xml> [repetitions]
+ */
+
+//STL libraries
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+//API libraries
+#include "API/KusiakLayoutEvaluator.h"
+#include "API/Matrix.hpp"
+#include "API/WindScenario.h"
+
+//Project's libraries
+#include "functions.hpp"
+#include "initialization.hpp"
+#include "instrumentation.hpp"
+#include "mutation.hpp"
+#include "recombination.hpp"
+#include "scenario.hpp"
+#include "structures.hpp"
+#include "thread_pool.hpp"
+
+namespace {
+   // the number of heap allocations of the whole program
+   std::atomic<long long> allocations(0);
+
+   /*
+    * measure
+    *
+    * applies the operator repetitions times to each individual of the
+    * population and prints the mean latency and allocations per call. every
+    * individual is mutated once before, so that the workspaces are warm
+    */
+   void measure(const std::string& name, std::vector<individual> population, int repetitions,
+                const std::function<void(individual&)>& op) {
+      for (auto& indiv : population) {
+         op(indiv);
+      }
+      long long allocated = allocations;
+      auto start = std::chrono::steady_clock::now();
+      for (int r = 0; r < repetitions; ++r) {
+         for (auto& indiv : population) {
+            op(indiv);
+         }
+      }
+      double ns = std::chrono::duration<double, std::nano>(
+                     std::chrono::steady_clock::now() - start).count();
+      double calls = static_cast<double>(repetitions) * population.size();
+      std::cout << name << ": " << ns / calls / 1000.0 << " us, "
+                << (allocations - allocated) / calls << " allocations per call" << std::endl;
+   }
+
+   /*
+    * measure_wakes
+    *
+    * evaluates square grid layouts of growing size with the tiled and the
+    * streaming wake kernel of KusiakLayoutEvaluator, and with the tiled
+    * kernel split across a pool of one thread per core. the layouts are
+    * placed on a copy of the scenario which is enlarged to fit them and has
+    * no obstacles. the streaming kernel is quadratic as well but much
+    * slower, it is only run up to streamed_max turbines
+    */
+   void measure_wakes(const WindScenario& wscenario, const std::vector<int>& sizes,
+                      int streamed_max) {
+      WindScenario large(wscenario);
+      large.obstacles = Matrix<double>(0, 4);
+      double spacing = 8.0 * large.R * 1.01;
+      ThreadPool pool;
+      for (int n : sizes) {
+         int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(n))));
+         large.width = large.height = side * spacing;
+         Matrix<double> layout(n, 2);
+         for (int i = 0; i < n; ++i) {
+            layout.set(i, 0, (i % side) * spacing);
+            layout.set(i, 1, (i / side) * spacing);
+         }
+         KusiakLayoutEvaluator evaluator;
+         evaluator.initialize(large);
+         std::cout << "Wakes of " << n << " turbines:";
+         for (int mode = 0; mode < 3; ++mode) {
+            if (mode == 1 && n > streamed_max)
+               continue;
+            evaluator.setTiledWakes(mode != 1);
+            if (mode == 2) {
+               evaluator.setParallelFor([&pool](int count, const std::function<void(int)>& body) {
+                  pool.parallel_for(count, body);
+               });
+            }
+            auto start = std::chrono::steady_clock::now();
+            double cost = evaluator.evaluate(&layout);
+            double ms = std::chrono::duration<double, std::milli>(
+                           std::chrono::steady_clock::now() - start).count();
+            const char* names[] = { " tiled ", ", streamed ", ", tiled on a pool of " };
+            std::cout << names[mode] << (mode == 2 ? std::to_string(pool.size()) + " " : "")
+                      << ms << " ms (" << cost << ")";
+         }
+         std::cout << std::endl;
+      }
+   }
+
+   /*
+    * measure_precision
+    *
+    * evaluates the layouts of the population in double and in single
+    * precision (see KusiakLayoutEvaluator::setSinglePrecision) and prints
+    * the mean time of both and the largest relative error of the cost
+    */
+   void measure_precision(WindScenario& wscenario, std::vector<individual> population) {
+      KusiakLayoutEvaluator evaluator;
+      evaluator.initialize(wscenario);
+      double ms[2] = { 0.0, 0.0 };
+      double max_error = 0.0;
+      for (auto& indiv : population) {
+         auto layout = functions::individual_to_matrix<double>(indiv.layout);
+         double cost[2];
+         for (int single = 0; single < 2; ++single) {
+            evaluator.setSinglePrecision(single == 1);
+            auto start = std::chrono::steady_clock::now();
+            cost[single] = evaluator.evaluate(&layout);
+            ms[single] += std::chrono::duration<double, std::milli>(
+                             std::chrono::steady_clock::now() - start).count();
+         }
+         max_error = std::max(max_error, std::abs(cost[1] - cost[0]) / cost[0]);
+      }
+      std::cout << "Evaluation: double " << ms[0] / population.size() << " ms, single "
+                << ms[1] / population.size() << " ms, max relative error " << max_error
+                << std::endl;
+   }
+}
+
+void* operator new(std::size_t size) {
+   ++allocations;
+   if (void* p = std::malloc(size ? size : 1))
+      return p;
+   throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+   std::free(p);
+}
+
+int main(int argc, const char * argv[]) {
+   if (argc < 2) {
+      std::cout << "usage: " << argv[0] << " <scenario.xml> [repetitions]" << std::endl;
+      return 1;
+   }
+   int repetitions = argc > 2 ? std::atoi(argv[2]) : 20;
+   WindScenario wscenario(argv[1]);
+   Scenario scenario(wscenario);
+
+   // a generation of valid layouts of the usual size
+   std::mt19937 engine(1);
+   std::vector<individual> population(20);
+   for (auto& indiv : population) {
+      indiv.layout = initialization::random_layout(scenario, engine);
+   }
+   std::cout << "Mutating " << population.size() << " layouts of about "
+             << population[0].layout.size() << " turbines" << std::endl;
+
+   measure("creep(1000)", population, repetitions, [&](individual& indiv) {
+      mutation::creep(1000.0, indiv, scenario);
+   });
+   measure("random_reset(0.25)", population, repetitions, [&](individual& indiv) {
+      mutation::random_reset(0.25f, indiv, scenario);
+   });
+
+   // each call recombines the whole generation
+   std::vector<std::vector<individual>::iterator> parents;
+   for (auto it = population.begin(); it != population.end(); ++it) {
+      parents.push_back(it);
+   }
+   measure("crossover, " + std::to_string(parents.size()) + " children", { population[0] },
+           repetitions,
+           [&](individual&) {
+      for (auto& child : recombination::crossover(parents, scenario)) {
+         // keep the children from being optimized away
+         if (child.layout.empty())
+            std::cout << "empty child" << std::endl;
+      }
+   });
+
+   // maximal layouts, where hardly any creep step is valid
+   std::vector<individual> dense(population.size());
+   for (auto& indiv : dense) {
+      indiv.layout = initialization::poisson_disk_layout(scenario, engine);
+   }
+   std::cout << "Mutating " << dense.size() << " maximal layouts of about "
+             << dense[0].layout.size() << " turbines" << std::endl;
+   measure("creep(1000), maximal", dense, repetitions, [&](individual& indiv) {
+      mutation::creep(1000.0, indiv, scenario);
+   });
+
+   measure_precision(wscenario, population);
+   measure_precision(wscenario, dense);
+   measure_wakes(wscenario, { 1000, 2000, 5000, 10000 }, 2000);
+   BBO_REPORT_TOTAL();
+   return 0;
+}
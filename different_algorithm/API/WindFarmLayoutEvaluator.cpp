@@ -1,4 +1,4 @@
 #include "WindFarmLayoutEvaluator.h"
 
-int WindFarmLayoutEvaluator::nEvals=0;
+std::atomic<int> WindFarmLayoutEvaluator::nEvals(0);
 
@@ -3,6 +3,7 @@
 
 #include "Matrix.hpp"
 #include "WindScenario.h"
+#include <atomic>
 
 /**
  * The class WindFarmLayoutEvaluator is an interface to easily exchange the
@@ -95,11 +96,13 @@ class WindFarmLayoutEvaluator {
  
     /**
      * Returns the global number of time the evaluation function has been called.
+     * The counter is shared by all evaluators and may be increased by
+     * evaluators running on different threads.
      */
   int getNumberOfEvaluation() {return nEvals;};
  
  protected:
-  static int nEvals;
+  static std::atomic<int> nEvals;
 };
 
 #endif /* defined(__WIND_FARM_LAYOUT_EVALUATOR_H__) */
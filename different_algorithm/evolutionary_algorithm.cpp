@@ -16,11 +16,30 @@ std::pair<double, double> evolutionary_algorithm(
                                   int generations,
                                   bool should_load,
                                   bool should_save) {
+   // only exact repetitions are answered from the cache
+   LayoutCache cache(0.0, 0.0);
+   return evolutionary_algorithm(evaluator, scenario, initialize, select, recombine,
+                                 mutate, replace, generations, should_load, should_save,
+                                 cache);
+}
+
+std::pair<double, double> evolutionary_algorithm(
+                                  WindFarmLayoutEvaluator& evaluator,
+                                  Scenario& scenario,
+                                  initialization_func initialize,
+                                  selection_func select,
+                                  recombination_func recombine,
+                                  mutation_func mutate,
+                                  replacement_func replace,
+                                  int generations,
+                                  bool should_load,
+                                  bool should_save,
+                                  LayoutCache& cache) {
    // intialization step
    std::string file_name = "population.txt";
    auto population = should_load ?
       functions::load_population_from_file(file_name) : initialize(scenario);
-   functions::evaluate_population(evaluator, scenario, population);
+   cache.evaluate_population(evaluator, scenario, population);
    // return if pop_size is 0 or loading failed
    if (population.empty())
       return{ 0.0, 0.0 };
@@ -56,7 +75,7 @@ std::pair<double, double> evolutionary_algorithm(
          mutate(children[i], children.size() - i + 1, scenario);
       } 
       // determine the fitness of the children
-      functions::evaluate_population(evaluator, scenario, children);
+      cache.evaluate_population(evaluator, scenario, children);
 
       // replacement step
       population = replace(population, children);
@@ -85,6 +104,8 @@ std::pair<double, double> evolutionary_algorithm(
       std::cout << gworst->fitness << ", " << gworst->phi << ", " << gworst->rw << std::endl;*/
    }
    //std::cout << "Evaluations used: " << evaluator.getNumberOfEvaluation() << std::endl;
+   std::cout << "Layout cache: " << cache.hits() << " hits, "
+             << cache.misses() << " misses" << std::endl;
 
    if (should_save) {
       functions::save_population_to_file(file_name, population);
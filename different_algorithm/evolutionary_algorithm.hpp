@@ -8,6 +8,7 @@
 #define BBO_EVOLUTIONARY_ALGORITHM_HPP
 
 #include "API/WindFarmLayoutEvaluator.h"
+#include "layout_cache.hpp"
 #include "scenario.hpp"
 #include "structures.hpp"
 
@@ -61,4 +62,24 @@ std::pair<double, double> evolutionary_algorithm(
                                   bool should_load,
                                   bool should_save);
 
+/*
+ * evolutionary_algorithm
+ *
+ * the same as above, but every layout is evaluated through the given cache,
+ * which is kept across generations (and may be kept across runs), so that
+ * repeated or nearly repeated individuals don't call the evaluator again
+ */
+std::pair<double, double> evolutionary_algorithm(
+                                  WindFarmLayoutEvaluator& evaluator,
+                                  Scenario& scenario,
+                                  initialization_func initialize,
+                                  selection_func select,
+                                  recombination_func recombine,
+                                  mutation_func mutate,
+                                  replacement_func replace,
+                                  int generations,
+                                  bool should_load,
+                                  bool should_save,
+                                  LayoutCache& cache);
+
 #endif
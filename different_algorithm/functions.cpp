@@ -1,66 +1,137 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <random>
 #include <vector>
 #include <fstream>
 #include "functions.hpp"
 
 namespace functions {      
-   bool turbine_valid(Scenario& scenario, double x, double y) {
-      if (x < 0.0 || x > scenario.width)
-         return false;
+   namespace {
+      // a row of turbines at (x + t * dx, y + t * dy) for integer t
+      struct row {
+         double x, y, dx, dy;
+      };
 
-      if (y < 0.0 || y > scenario.height)
-         return false;
+      /*
+       * clip
+       *
+       * narrows [t_min, t_max] to the t for which lo <= base + t * step <= hi
+       * step is never negative, since the row directions are absolute values
+       */
+      void clip(double base, double step, double lo, double hi,
+                double& t_min, double& t_max) {
+         if (step > 0.0) {
+            t_min = std::max(t_min, (lo - base) / step);
+            t_max = std::min(t_max, (hi - base) / step);
+         } else if (base < lo || base > hi) {
+            t_min = 1.0;
+            t_max = 0.0;
+         }
+      }
 
-      for (int o = 0; o < scenario.obstacles.rows; ++o) {
-         if (x >= scenario.obstacles.get(o, 0) &&
-             x <= scenario.obstacles.get(o, 2) &&
-             y >= scenario.obstacles.get(o, 1) &&
-             y <= scenario.obstacles.get(o, 3)) {
+      /*
+       * integer_range
+       *
+       * finds the integer t of a row which lie in the closed rectangle
+       * [x0, x1] x [y0, y1]. the ends of the range are checked on the actual
+       * coordinates, so rounding can neither add nor drop a border point
+       *
+       * returns:
+       *    false if the row misses the rectangle
+       */
+      bool integer_range(const row& r, double x0, double y0, double x1, double y1,
+                         long long& first, long long& last) {
+         double t_min = -std::numeric_limits<double>::max();
+         double t_max = std::numeric_limits<double>::max();
+         clip(r.x, r.dx, x0, x1, t_min, t_max);
+         clip(r.y, r.dy, y0, y1, t_min, t_max);
+         if (t_min > t_max + 1.0)
             return false;
-         }
+         auto inside = [&](long long t) {
+            double x = r.x + t * r.dx;
+            double y = r.y + t * r.dy;
+            return x >= x0 && x <= x1 && y >= y0 && y <= y1;
+         };
+         first = static_cast<long long>(std::ceil(t_min)) - 1;
+         last = static_cast<long long>(std::floor(t_max)) + 1;
+         while (first <= last && !inside(first))
+            ++first;
+         while (last >= first && !inside(last))
+            --last;
+         return first <= last;
       }
-      return true;
-   }  
-   
-   Matrix<double> individual_to_matrix(Scenario& scenario, const individual& indiv) {
-      // create turbines along the rows determined by phi (angle) and rw (row width)
-      std::vector<std::pair<double, double>> coords;
-      double min_rw = scenario.R * 8.0001;
-      double erw = std::abs(indiv.rw * std::sin(indiv.phi));
-      double erh = std::abs(indiv.rw * std::cos(indiv.phi));
-      double x = 0.0, y = 0.0;
-      while (x >= -scenario.width && y <= scenario.height) {
-         for (double x2 = x, y2 = y; x2 <= scenario.width && y2 <= scenario.height;) {
-            if (turbine_valid(scenario, x2, y2)) {
-               coords.push_back({ x2, y2 });
+
+      /*
+       * for_each_segment
+       *
+       * calls emit(row, first, last) for every run of consecutive turbines
+       * of the layout encoded by indiv, in closed form: each row is clipped by
+       * the farm and the obstacles instead of testing candidate points
+       */
+      template<typename F>
+      void for_each_segment(Scenario& scenario, const individual& indiv, F emit) {
+         double erw = std::abs(indiv.rw * std::sin(indiv.phi));
+         double erh = std::abs(indiv.rw * std::cos(indiv.phi));
+         double rw2 = erw * erw + erh * erh;
+         // row m starts at m * (-erh, erw) and runs along (erw, erh), so the
+         // farm corners (width, 0) and (0, height) bound the rows crossing it
+         long long m_min = static_cast<long long>(std::floor(-scenario.width * erh / rw2)) - 1;
+         long long m_max = static_cast<long long>(std::ceil(scenario.height * erw / rw2)) + 1;
+
+         std::vector<std::pair<long long, long long>> blocked;
+         for (long long m = m_min; m <= m_max; ++m) {
+            row r = { -m * erh, m * erw, erw, erh };
+            long long first, last;
+            if (!integer_range(r, 0.0, 0.0, scenario.width, scenario.height, first, last))
+               continue;
+            // the parts of the row covered by obstacles
+            blocked.clear();
+            for (int o = 0; o < scenario.obstacles.rows; ++o) {
+               long long b_first, b_last;
+               if (integer_range(r, scenario.obstacles.get(o, 0), scenario.obstacles.get(o, 1),
+                                 scenario.obstacles.get(o, 2), scenario.obstacles.get(o, 3),
+                                 b_first, b_last)) {
+                  blocked.push_back({ b_first, b_last });
+               }
             }
-            x2 += erw;
-            y2 += erh;
-         }
-         x -= erh;
-         y += erw;
-      }
-      x = erh; y = -erw;
-      while (x <= scenario.width && y >= -scenario.height) {
-         for (double x2 = x, y2 = y; x2 <= scenario.width && y2 <= scenario.height;) {
-            if (turbine_valid(scenario, x2, y2)) {
-               coords.push_back({ x2, y2 });
+            std::sort(blocked.begin(), blocked.end());
+            long long t = first;
+            for (auto& b : blocked) {
+               if (b.first > last)
+                  break;
+               if (b.first > t)
+                  emit(r, t, b.first - 1);
+               t = std::max(t, b.second + 1);
             }
-            x2 += erw;
-            y2 += erh;
+            if (t <= last)
+               emit(r, t, last);
          }
-         x += erh;
-         y -= erw;
       }
+   }
+
+   int layout_size(Scenario& scenario, const individual& indiv) {
+      long long count = 0;
+      for_each_segment(scenario, indiv, [&](const row&, long long first, long long last) {
+         count += last - first + 1;
+      });
+      return static_cast<int>(count);
+   }
 
-      // to hold the result
-      Matrix<double> matrix(coords.size(), 2);
-      // to keep track of the turbine count
-      int i = 0;
-      for (auto& coord : coords) {
-         matrix.set(i, 0, coord.first);
-         matrix.set(i, 1, coord.second);
-         i++;
+   void individual_to_buffer(Scenario& scenario, const individual& indiv, double* out) {
+      for_each_segment(scenario, indiv, [&](const row& r, long long first, long long last) {
+         for (long long t = first; t <= last; ++t) {
+            *out++ = r.x + t * r.dx;
+            *out++ = r.y + t * r.dy;
+         }
+      });
+   }
+
+   Matrix<double> individual_to_matrix(Scenario& scenario, const individual& indiv) {
+      // count the turbines first, then write them straight into the matrix
+      Matrix<double> matrix(layout_size(scenario, indiv), 2);
+      if (matrix.rows > 0) {
+         individual_to_buffer(scenario, indiv, &matrix(0, 0));
       }
       return matrix;
    }
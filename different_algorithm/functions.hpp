@@ -22,6 +22,28 @@ namespace functions {
     */
    Matrix<double> individual_to_matrix(Scenario& scenario, const individual& indiv);
 
+   /* layout_size
+    *
+    * the number of turbines in the layout of an individual, without expanding it
+    *
+    * parameters:
+    *    scenario - the scenario the layout is based on
+    *    indiv - the individual
+    */
+   int layout_size(Scenario& scenario, const individual& indiv);
+
+   /* individual_to_buffer
+    *
+    * writes the layout of an individual as x, y pairs into out, which must
+    * hold 2 * layout_size(scenario, indiv) values
+    *
+    * parameters:
+    *    scenario - the scenario the layout is based on
+    *    indiv - the individual
+    *    out - the preallocated output buffer
+    */
+   void individual_to_buffer(Scenario& scenario, const individual& indiv, double* out);
+
    /* 
     * evaluate_population
     *
@@ -0,0 +1,40 @@
+#include "layout_cache.hpp"
+#include "functions.hpp"
+
+#include <cmath>
+#include <cstring>
+
+LayoutCache::LayoutCache(double phi_resolution, double rw_resolution)
+   : phi_resolution(phi_resolution), rw_resolution(rw_resolution),
+     hit_count(0), miss_count(0) {}
+
+long long LayoutCache::quantize(double value, double resolution) const {
+   if (resolution > 0.0)
+      return std::llround(value / resolution);
+   // without a resolution the value itself is the key
+   long long bits;
+   std::memcpy(&bits, &value, sizeof(bits));
+   return bits;
+}
+
+void LayoutCache::evaluate(WindFarmLayoutEvaluator& evaluator, Scenario& scenario,
+                           individual& indiv) {
+   key k(quantize(indiv.phi, phi_resolution), quantize(indiv.rw, rw_resolution));
+   auto entry = entries.find(k);
+   if (entry != entries.end()) {
+      indiv = entry->second;
+      ++hit_count;
+      return;
+   }
+   Matrix<double> matrix = functions::individual_to_matrix(scenario, indiv);
+   indiv.fitness = evaluator.evaluate(&matrix);
+   entries.insert({ k, indiv });
+   ++miss_count;
+}
+
+void LayoutCache::evaluate_population(WindFarmLayoutEvaluator& evaluator, Scenario& scenario,
+                                      std::vector<individual>& population) {
+   for (auto& indiv : population) {
+      evaluate(evaluator, scenario, indiv);
+   }
+}
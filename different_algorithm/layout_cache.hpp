@@ -0,0 +1,68 @@
+/*
+ * layout_cache.hpp
+ *
+ * contains a cache between the expansion of an individual and its evaluation
+ */
+#ifndef BBO_LAYOUT_CACHE_HPP
+#define BBO_LAYOUT_CACHE_HPP
+
+#include "API/WindFarmLayoutEvaluator.h"
+#include "scenario.hpp"
+#include "structures.hpp"
+
+#include <map>
+#include <utility>
+#include <vector>
+
+/*
+ * LayoutCache
+ *
+ * maps a quantized (phi, rw) pair to the individual which was evaluated for
+ * it. since the genotype determines the layout, the cached individual stands
+ * for its layout and fitness: an individual which falls into the same cell
+ * takes over the cached phi, rw and fitness, so the fitness always belongs
+ * to the layout the individual encodes
+ *
+ * a resolution of 0 only matches exactly equal values
+ * the cache is not synchronized, use one per thread
+ */
+class LayoutCache {
+public:
+   LayoutCache(double phi_resolution, double rw_resolution);
+
+   /*
+    * LayoutCache::evaluate
+    *
+    * answers the individual from the cache, or evaluates and caches it
+    *
+    * parameters:
+    *    evaluator - evaluates the layouts which are not cached yet
+    *    scenario - the scenario the layouts are based on
+    *    indiv - the individual, snapped to the cached one on a hit
+    */
+   void evaluate(WindFarmLayoutEvaluator& evaluator, Scenario& scenario, individual& indiv);
+
+   /*
+    * LayoutCache::evaluate_population
+    *
+    * the cached version of functions::evaluate_population
+    */
+   void evaluate_population(WindFarmLayoutEvaluator& evaluator, Scenario& scenario,
+                            std::vector<individual>& population);
+
+   int hits() const { return hit_count; }
+   int misses() const { return miss_count; }
+
+private:
+   using key = std::pair<long long, long long>;
+
+   long long quantize(double value, double resolution) const;
+
+   double phi_resolution;
+   double rw_resolution;
+   std::map<key, individual> entries;
+   int hit_count;
+   int miss_count;
+};
+
+#endif
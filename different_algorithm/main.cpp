@@ -24,7 +24,9 @@
 #include "replacement.hpp"
 #include "evolutionary_algorithm.hpp"
 #include "statistical_comparison.hpp"
+#include "layout_cache.hpp"
 #include "scenario.hpp"
+#include "sweep.hpp"
 #include <time.h>
 #include <stdlib.h>
 #include <fstream>
@@ -71,6 +73,7 @@ void start_run() {
    std::unique_ptr<CompetitionScenario> cscenario;
    std::unique_ptr<WindScenario> wscenario;
    std::unique_ptr<Scenario> scenario;
+   sweep::evaluator_factory make_evaluator;
    if (serious_mode) {
       int sc_number;
       std::cout << "Scenario number? (1 to 5)" << std::endl;
@@ -80,6 +83,11 @@ void start_run() {
       CompetitionEvaluator* cevaluator = new CompetitionEvaluator();
       cevaluator->initialize(*cscenario, "XQNC1VSQ112N3I45DP56D87RYODN7Z");
       evaluator.reset(cevaluator);
+      make_evaluator = [&cscenario]() {
+         CompetitionEvaluator* worker_evaluator = new CompetitionEvaluator();
+         worker_evaluator->initialize(*cscenario, "XQNC1VSQ112N3I45DP56D87RYODN7Z");
+         return std::unique_ptr<WindFarmLayoutEvaluator>(worker_evaluator);
+      };
    } else {
       std::string scenario_path;
       std::cout << "Enter the test scenario path: " << std::endl;
@@ -89,6 +97,31 @@ void start_run() {
       KusiakLayoutEvaluator* kevaluator = new KusiakLayoutEvaluator();
       kevaluator->initialize(*wscenario);
       evaluator.reset(kevaluator);
+      make_evaluator = [&wscenario]() {
+         KusiakLayoutEvaluator* worker_evaluator = new KusiakLayoutEvaluator();
+         worker_evaluator->initialize(*wscenario);
+         return std::unique_ptr<WindFarmLayoutEvaluator>(worker_evaluator);
+      };
+   }
+
+   bool run_sweep = false;
+   std::cout << "Run the grid sweep instead of the evolutionary algorithm? (0/1)" << std::endl;
+   std::cin >> run_sweep;
+   if (run_sweep) {
+      sweep::config cfg;
+      std::cout << "Enter the number of lattice points along phi and rw: " << std::endl;
+      std::cin >> cfg.phi_steps >> cfg.rw_steps;
+      std::cout << "Enter the number of refinement levels: " << std::endl;
+      std::cin >> cfg.levels;
+      std::cout << "Enter the number of threads (0 for all cores): " << std::endl;
+      std::cin >> cfg.threads;
+      cfg.refine_points = 4;
+      cfg.refine_factor = 4;
+      auto best = sweep::grid_sweep(make_evaluator, *scenario, cfg);
+      std::cout << "Best: " << best.fitness
+                << ", phi: " << best.phi
+                << ", rw: " << best.rw << std::endl;
+      return;
    }
        
    int pop_size = 0;
@@ -112,6 +145,12 @@ void start_run() {
    }       
    std::cout << "Enter the number of generations: " << std::endl;
    std::cin >> generations;
+   double phi_resolution = 0.0;
+   double rw_resolution = 0.0;
+   std::cout << "Enter the layout cache resolution of phi and rw (0 0 for exact matches): "
+             << std::endl;
+   std::cin >> phi_resolution >> rw_resolution;
+   LayoutCache cache(phi_resolution, rw_resolution);
  
    auto result = evolutionary_algorithm(
       *evaluator, *scenario,
@@ -121,7 +160,8 @@ void start_run() {
       mutation::incremental,
       std::bind(replacement::replacement_1, _1, _2, pop_size),
       generations,
-      should_load, should_save);
+      should_load, should_save,
+      cache);
    std::cout << "Best: " << result.first
              << ", Improvement: " << result.second << std::endl;   
 }
@@ -0,0 +1,145 @@
+#include "sweep.hpp"
+#include "functions.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace sweep {
+   namespace {
+      // a lattice point in units of the finest spacing (phi index, rw index)
+      using point = std::pair<long long, long long>;
+
+      // evaluates the points in parallel, each thread with its own evaluator
+      std::vector<double> evaluate_points(
+                             std::vector<std::unique_ptr<WindFarmLayoutEvaluator>>& evaluators,
+                             Scenario& scenario,
+                             const std::vector<individual>& points) {
+         std::vector<double> fitness(points.size());
+         std::atomic<std::size_t> next(0);
+         auto work = [&](WindFarmLayoutEvaluator& evaluator) {
+            for (std::size_t i = next++; i < points.size(); i = next++) {
+               Matrix<double> layout = functions::individual_to_matrix(scenario, points[i]);
+               fitness[i] = evaluator.evaluate(&layout);
+            }
+         };
+         std::vector<std::thread> threads;
+         for (std::size_t t = 1; t < evaluators.size(); ++t) {
+            threads.emplace_back(work, std::ref(*evaluators[t]));
+         }
+         // the calling thread works as well
+         work(*evaluators[0]);
+         for (auto& thread : threads) {
+            thread.join();
+         }
+         return fitness;
+      }
+   }
+
+   individual grid_sweep(evaluator_factory make_evaluator, Scenario& scenario,
+                         const config& cfg) {
+      int phi_steps = std::max(cfg.phi_steps, 2);
+      int rw_steps = std::max(cfg.rw_steps, 2);
+      int levels = std::max(cfg.levels, 1);
+      int factor = std::max(cfg.refine_factor, 2);
+      int threads = cfg.threads > 0 ?
+         cfg.threads : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+      // the same limits as the initialization and mutation
+      double min_phi = 0.0;
+      double max_phi = M_PI / 2;
+      double min_rw = scenario.R * 8.0001;
+      double max_rw = scenario.R * 16.0001;
+
+      // the spacing of each level in units of the finest spacing
+      std::vector<long long> unit(levels);
+      unit[levels - 1] = 1;
+      for (int l = levels - 2; l >= 0; --l) {
+         unit[l] = unit[l + 1] * factor;
+      }
+      long long max_phi_index = (phi_steps - 1) * unit[0];
+      long long max_rw_index = (rw_steps - 1) * unit[0];
+      double phi_spacing = (max_phi - min_phi) / max_phi_index;
+      double rw_spacing = (max_rw - min_rw) / max_rw_index;
+      auto to_individual = [&](const point& p) {
+         return individual{ min_phi + p.first * phi_spacing,
+                            min_rw + p.second * rw_spacing,
+                            std::numeric_limits<double>::max() };
+      };
+
+      std::vector<std::unique_ptr<WindFarmLayoutEvaluator>> evaluators;
+      for (int t = 0; t < threads; ++t) {
+         evaluators.push_back(make_evaluator());
+      }
+
+      // the fitness of every point evaluated so far, so that the refinements of
+      // neighbouring points never expand and evaluate the same layout twice
+      std::map<point, double> cache;
+      std::vector<point> pending;
+      for (long long p = 0; p <= max_phi_index; p += unit[0]) {
+         for (long long r = 0; r <= max_rw_index; r += unit[0]) {
+            pending.push_back({ p, r });
+         }
+      }
+
+      point best(0, 0);
+      double best_fitness = std::numeric_limits<double>::max();
+      for (int l = 0; l < levels; ++l) {
+         if (l > 0) {
+            // refine the cells around the best points of the previous levels
+            std::vector<std::pair<double, point>> ranked;
+            for (auto& entry : cache) {
+               ranked.push_back({ entry.second, entry.first });
+            }
+            std::size_t count = std::min(ranked.size(),
+                                         static_cast<std::size_t>(std::max(cfg.refine_points, 1)));
+            std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end());
+            for (std::size_t i = 0; i < count; ++i) {
+               point center = ranked[i].second;
+               for (int dp = -factor; dp <= factor; ++dp) {
+                  for (int dr = -factor; dr <= factor; ++dr) {
+                     point p(center.first + dp * unit[l], center.second + dr * unit[l]);
+                     if (p.first < 0 || p.first > max_phi_index ||
+                         p.second < 0 || p.second > max_rw_index)
+                        continue;
+                     if (cache.count(p))
+                        continue;
+                     // reserve the point so that overlapping cells don't add it twice
+                     cache[p] = std::numeric_limits<double>::max();
+                     pending.push_back(p);
+                  }
+               }
+            }
+         }
+
+         std::vector<individual> points;
+         for (auto& p : pending) {
+            points.push_back(to_individual(p));
+         }
+         auto fitness = evaluate_points(evaluators, scenario, points);
+         for (std::size_t i = 0; i < pending.size(); ++i) {
+            cache[pending[i]] = fitness[i];
+            if (fitness[i] < best_fitness) {
+               best_fitness = fitness[i];
+               best = pending[i];
+            }
+         }
+         auto fittest = to_individual(best);
+         std::cout << "Sweep level " << l << ": " << pending.size() << " layouts"
+                   << ", best fitness: " << best_fitness
+                   << ", phi: " << fittest.phi
+                   << ", rw: " << fittest.rw << std::endl;
+         pending.clear();
+      }
+
+      individual result = to_individual(best);
+      result.fitness = best_fitness;
+      return result;
+   }
+}
@@ -0,0 +1,60 @@
+/*
+ * sweep.hpp
+ *
+ * contains a deterministic optimizer for the (phi, rw) encoding,
+ * which searches the two dimensional genotype space on a refined lattice
+ */
+#ifndef BBO_SWEEP_HPP
+#define BBO_SWEEP_HPP
+
+#include "API/WindFarmLayoutEvaluator.h"
+#include "scenario.hpp"
+#include "structures.hpp"
+
+#include <functional>
+#include <memory>
+
+namespace sweep {
+   // creates a new, initialized evaluator (one for each thread of the sweep)
+   using evaluator_factory = std::function<std::unique_ptr<WindFarmLayoutEvaluator>()>;
+
+   /* struct config
+    *
+    * the resolution of the sweep
+    */
+   struct config {
+      // the number of lattice points along phi and rw on the first level
+      int phi_steps;
+      int rw_steps;
+      // the number of levels, each one refines around the best points
+      int levels;
+      // the number of best points which are refined on each level
+      int refine_points;
+      // by how much the lattice spacing shrinks from one level to the next
+      int refine_factor;
+      // the number of threads, 0 for one per hardware thread
+      int threads;
+   };
+
+   /*
+    * sweep::grid_sweep
+    *
+    * evaluates a lattice over phi in [0, PI / 2] and rw in
+    * [scenario.R * 8, scenario.R * 16] (the same ranges as the mutation uses),
+    * then repeatedly evaluates a finer lattice around the best points found
+    * so far. every point is evaluated at most once, also across levels, and
+    * the points of a level are evaluated in parallel
+    *
+    * parameters:
+    *    make_evaluator - creates the evaluator of each thread
+    *    scenario - the wind scenario the layouts are based on
+    *    cfg - the resolution of the sweep
+    *
+    * returns:
+    *    the best individual found, with its fitness
+    */
+   individual grid_sweep(evaluator_factory make_evaluator, Scenario& scenario,
+                         const config& cfg);
+}
+
+#endif
@@ -3,8 +3,12 @@
 #include "evolutionary_algorithm.hpp"
 #include "functions.hpp"
 #include "initialization.hpp"
+#include "instrumentation.hpp"
+#include "run_controller.hpp"
 #include "scenario.hpp"
 
+#include <algorithm>
+
 std::pair<double, double> evolutionary_algorithm(
                                   WindFarmLayoutEvaluator& evaluator,
                                   Scenario& scenario,
@@ -16,9 +20,57 @@ std::pair<double, double> evolutionary_algorithm(
                                   int generations,
                                   bool shouldLoadFile,
                                   bool shouldSaveFile) {
+   // 0 generations runs only the initialization, as it always did,
+   // while a generation limit of 0 in a budget means no limit
+   run_budget budget = { generations > 0 ? generations : -1, 0, 0.0, 0, 0.0, false };
+   return evolutionary_algorithm(evaluator, scenario, initialize, select,
+                                 recombine, mutate, replace, budget,
+                                 shouldLoadFile, shouldSaveFile);
+}
+
+std::pair<double, double> evolutionary_algorithm(
+                                  WindFarmLayoutEvaluator& evaluator,
+                                  Scenario& scenario,
+                                  initialization_func initialize,
+                                  selection_func select,
+                                  recombination_func recombine,
+                                  mutation_func mutate,
+                                  replacement_func replace,
+                                  const run_budget& budget,
+                                  bool shouldLoadFile,
+                                  bool shouldSaveFile) {
+   auto evaluate = [](WindFarmLayoutEvaluator& evaluator, std::vector<individual>& children,
+                      int /*generation*/) {
+      for (auto& child : children) {
+         functions::evaluate_individual(evaluator, child);
+      }
+   };
+   return evolutionary_algorithm(evaluator, scenario, initialize, select,
+                                 recombine, mutate, replace, evaluate, budget,
+                                 shouldLoadFile, shouldSaveFile);
+}
+
+std::pair<double, double> evolutionary_algorithm(
+                                  WindFarmLayoutEvaluator& evaluator,
+                                  Scenario& scenario,
+                                  initialization_func initialize,
+                                  selection_func select,
+                                  recombination_func recombine,
+                                  mutation_func mutate,
+                                  replacement_func replace,
+                                  evaluation_func evaluate,
+                                  const run_budget& budget,
+                                  bool shouldLoadFile,
+                                  bool shouldSaveFile) {
+   // the run starts now, so that the evaluations of the initialization count
+   RunController controller(evaluator, budget);
    // intialization step
    string file_name = "population.txt";
-   std::vector<individual> population = shouldLoadFile ? functions::load_population_from_file(file_name) : initialize(evaluator, scenario);
+   std::vector<individual> population;
+   {
+      BBO_TIME_PHASE(initialize);
+      population = shouldLoadFile ? functions::load_population_from_file(file_name) : initialize(evaluator, scenario);
+   }
    std::cout << "Initial population:" << std::endl;
    for (auto& indiv : population){
      std::cout << indiv.fitness << " : " << indiv.layout.size() << std::endl;
@@ -34,26 +86,64 @@ std::pair<double, double> evolutionary_algorithm(
    double initial_fittest = fittest;
    std::cout << "Initial fittest: " << fittest << std::endl;
    
-   for (int g = 0; g < generations; ++g) {
+   for (int g = 0; !controller.exhausted(); ++g) {
       // selection step
-      std::vector<std::vector<individual>::iterator> parents = select(population);
+      std::vector<std::vector<individual>::iterator> parents;
+      {
+         BBO_TIME_PHASE(select);
+         parents = select(population);
+      }
       
       // recombination, mutation step
-      std::vector<individual> children = recombine(parents, scenario);
-      for (auto& child : children) {
-	     mutate(child, scenario);
+      std::vector<individual> children;
+      {
+         BBO_TIME_PHASE(recombine);
+         children = recombine(parents, scenario);
+      }
+      {
+         BBO_TIME_PHASE(mutate);
+         for (auto& child : children) {
+            mutate(child, scenario);
+         }
       }
       
+      // never exceed the evaluation budget, the last generation
+      // might only be able to evaluate some of its children
+      std::size_t remaining = controller.remaining_evaluations();
+      bool partial = children.size() > remaining;
+      if (partial) {
+         children.resize(remaining);
+      }
+
       // determine the fitness of the children
+      {
+         BBO_TIME_PHASE(remove_illegal);
+         for (auto& child : children) {
+            functions::remove_illegal_coordinates(child, scenario);
+         }
+      }
+      {
+         BBO_TIME_PHASE(evaluate);
+         evaluate(evaluator, children, g);
+      }
       for (auto& child : children) {
-         functions::remove_illegal_coordinates(child, scenario);
-         auto mat_layout = functions::individual_to_matrix<double>(child.layout);
-         child.fitness = evaluator.evaluate(&mat_layout);
          std::cout << child.fitness << " : " << child.layout.size() << std::endl;
       }
 
+      // there are not enough children for a replacement,
+      // but they still might contain a new fittest member
+      if (partial) {
+         for (auto& child : children) {
+            fittest = std::min(fittest, child.fitness);
+         }
+         break;
+      }
+
       // replacement step
-      population = replace(population, children);
+      {
+         BBO_TIME_PHASE(replace);
+         population = replace(population, children);
+      }
       // update the fittest member
       for (auto iter = population.begin(); iter != population.end(); ++iter) {
          if (fittest > iter->fitness) {
@@ -61,7 +151,36 @@ std::pair<double, double> evolutionary_algorithm(
          }
       }
       std::cout << "Fittest at generation " << g + 1 << " : " << fittest << endl;
-   } std::cout << "evals: " << evaluator.getNumberOfEvaluation() << std::endl;
+      BBO_REPORT_GENERATION(g + 1);
+
+      // stop or restart if the fittest member hasn't improved for too long
+      if (controller.next_generation(fittest)) {
+         std::cout << "Stagnated at generation " << g + 1 << ": "
+                   << controller.stop_reason() << std::endl;
+         // a restart needs a full new population worth of evaluations
+         if (!budget.restart_on_stagnation ||
+             controller.remaining_evaluations() < (int) population.size()) {
+            break;
+         }
+         // keep the best member, so that nothing is lost by the restart
+         individual best = *std::min_element(population.begin(), population.end(),
+            [](const individual& a, const individual& b) { return a.fitness < b.fitness; });
+         {
+            BBO_TIME_PHASE(initialize);
+            population = initialize(evaluator, scenario);
+         }
+         *std::max_element(population.begin(), population.end(),
+            [](const individual& a, const individual& b) { return a.fitness < b.fitness; }) = best;
+         controller.restart();
+         std::cout << "Restart " << controller.restarts() << " after generation "
+                   << g + 1 << std::endl;
+      }
+   }
+   std::cout << "Stopped after " << controller.generations() << " generations, "
+             << controller.evaluations_used() << " evaluations and "
+             << controller.seconds_used() << "s: " << controller.stop_reason() << std::endl;
+   std::cout << "evals: " << evaluator.getNumberOfEvaluation() << std::endl;
+   BBO_REPORT_TOTAL();
     if (shouldSaveFile){
         functions::save_population_to_file(file_name, population);
     }
@@ -8,7 +8,9 @@
 #define BBO_EVOLUTIONARY_ALGORITHM_HPP
 
 #include <functional>
+#include <memory>
 
+#include "run_controller.hpp"
 #include "structures.hpp"
 
 class WindFarmLayoutEvaluator;
@@ -28,6 +30,16 @@ using mutation_func = std::function<void(individual&, Scenario&)>;
 using replacement_func = std::function<std::vector<individual>(
                                        std::vector<individual>&,
                                        std::vector<individual>&)>;
+// inserts one evaluated child into the population (steady-state replacement)
+using insertion_func = std::function<void(std::vector<individual>&, individual&)>;
+// creates a new, initialized evaluator (e.g. one for each worker thread)
+using evaluator_factory = std::function<std::unique_ptr<WindFarmLayoutEvaluator>()>;
+// assigns a fitness to each of the (legal) children of a generation,
+// e.g. exactly one by one or after a pre-screening with a surrogate.
+// children it doesn't evaluate exactly are removed from the vector
+using evaluation_func = std::function<void(WindFarmLayoutEvaluator&,
+                                           std::vector<individual>&,
+                                           int generation)>;
 /*
  * evolutionary_algorithm
  *
@@ -58,4 +70,54 @@ std::pair<double, double> evolutionary_algorithm(
                                   bool shouldLoadFile,
                                   bool shouldSaveFile);
 
+/*
+ * evolutionary_algorithm
+ *
+ * executes an evolutionary algorithm with the specified functions
+ * until the budget is used up (see run_controller.hpp)
+ * the evaluation budget is never exceeded: if the last generation has more
+ * children than evaluations left, only some of them are evaluated
+ * if the run stagnates it is either stopped or, when the budget allows it,
+ * restarted with a new population which keeps the best member
+ *
+ * parameters:
+ * budget - the generation, evaluation, time and stagnation limits of the run
+ * the other parameters are the same as above
+ */
+std::pair<double, double> evolutionary_algorithm(
+                                  WindFarmLayoutEvaluator& evaluator,
+                                  Scenario& scenario,
+                                  initialization_func initialize,
+                                  selection_func select,
+                                  recombination_func recombine,
+                                  mutation_func mutate,
+                                  replacement_func replace,
+                                  const run_budget& budget,
+                                  bool shouldLoadFile,
+                                  bool shouldSaveFile);
+
+/*
+ * evolutionary_algorithm
+ *
+ * the same as above, but the children of each generation are evaluated
+ * with the given function instead of one by one with the evaluator
+ * (the evaluation budget still only counts calls of the evaluator)
+ *
+ * parameters:
+ * evaluate - assigns the fitness of the children
+ * the other parameters are the same as above
+ */
+std::pair<double, double> evolutionary_algorithm(
+                                  WindFarmLayoutEvaluator& evaluator,
+                                  Scenario& scenario,
+                                  initialization_func initialize,
+                                  selection_func select,
+                                  recombination_func recombine,
+                                  mutation_func mutate,
+                                  replacement_func replace,
+                                  evaluation_func evaluate,
+                                  const run_budget& budget,
+                                  bool shouldLoadFile,
+                                  bool shouldSaveFile);
+
 #endif
@@ -0,0 +1,82 @@
+#include "fidelity.hpp"
+#include "functions.hpp"
+#include "instrumentation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numeric>
+
+FidelityScheduler::FidelityScheduler(std::shared_ptr<const CompiledScenario> scenario,
+                                     const fidelity_config& config)
+   : config(config), best_exact(std::numeric_limits<double>::max()),
+     max_relative_error(0.0), low_count(0), exact_count(0) {
+   low.initialize(scenario);
+   low.setDirectionShare(config.direction_share);
+   low.setSinglePrecision(config.single_precision);
+}
+
+void FidelityScheduler::evaluate(WindFarmLayoutEvaluator& evaluator,
+                                 std::vector<individual>& children, int generation) {
+   int exact_before = exact_count;
+   int low_before = low_count;
+   bool low_fidelity = config.low_fidelity_generations == 0 ||
+                       generation < config.low_fidelity_generations;
+
+   std::vector<bool> promoted(children.size(), true);
+   std::vector<double> low_fitness(children.size());
+   if (low_fidelity) {
+      std::vector<double> optimistic(children.size());
+      for (std::size_t i = 0; i < children.size(); ++i) {
+         auto matrix = functions::individual_to_matrix<double>(children[i].layout);
+         low_fitness[i] = low.evaluate(&matrix);
+         optimistic[i] = low.getEnergyCostLowerBound();
+         ++low_count;
+      }
+      BBO_COUNT(low_fidelity_evaluations, children.size());
+
+      if (config.policy == promotion::top_k) {
+         std::vector<std::size_t> order(children.size());
+         std::iota(order.begin(), order.end(), 0);
+         std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+            return low_fitness[a] < low_fitness[b];
+         });
+         for (std::size_t k = std::max(1, config.top_k); k < order.size(); ++k) {
+            promoted[order[k]] = false;
+         }
+      } else {
+         for (std::size_t i = 0; i < children.size(); ++i) {
+            promoted[i] = best_exact == std::numeric_limits<double>::max() ||
+                          optimistic[i] <= best_exact * (1.0 + config.tolerance);
+         }
+         // the replacement needs at least one child
+         if (!children.empty() &&
+             std::find(promoted.begin(), promoted.end(), true) == promoted.end()) {
+            promoted[std::min_element(low_fitness.begin(), low_fitness.end()) -
+                     low_fitness.begin()] = true;
+         }
+      }
+   }
+
+   // only the promoted children are kept, so that no child without an
+   // exact fitness can enter the population
+   std::vector<individual> evaluated;
+   for (std::size_t i = 0; i < children.size(); ++i) {
+      if (promoted[i]) {
+         double exact = functions::evaluate_individual(evaluator, children[i]);
+         best_exact = std::min(best_exact, exact);
+         ++exact_count;
+         // invalid layouts cost the maximum in both
+         if (low_fidelity && exact != std::numeric_limits<double>::max()) {
+            max_relative_error = std::max(max_relative_error,
+                                          std::abs(low_fitness[i] - exact) / exact);
+         }
+         evaluated.push_back(std::move(children[i]));
+      }
+   }
+   children.swap(evaluated);
+   std::cout << "Generation " << generation + 1 << " fidelity: "
+             << low_count - low_before << " low, "
+             << exact_count - exact_before << " exact" << std::endl;
+}
@@ -0,0 +1,79 @@
+/*
+ * fidelity.hpp
+ *
+ * contains a multi-fidelity schedule for the evaluation of the children
+ */
+#ifndef BBO_FIDELITY_HPP
+#define BBO_FIDELITY_HPP
+
+#include <memory>
+#include <vector>
+
+#include "API/KusiakLayoutEvaluator.h"
+#include "structures.hpp"
+
+// which children of a low-fidelity generation get an exact evaluation
+enum class promotion {
+   top_k,           // the top_k children with the best low-fidelity fitness
+   optimistic_bound // the children whose optimistic (lower) cost bound is
+                    // within the tolerance of the best exact fitness so far
+};
+
+/* struct fidelity_config
+ *
+ * the low-fidelity evaluator and the promotion policy
+ */
+struct fidelity_config {
+   // the share of the wake free energy the low-fidelity evaluator covers
+   // (see KusiakLayoutEvaluator::setDirectionShare)
+   double direction_share;
+   // whether the low-fidelity evaluator runs in single precision
+   // (see KusiakLayoutEvaluator::setSinglePrecision)
+   bool single_precision;
+   // the number of generations which start in low fidelity, 0 for all
+   int low_fidelity_generations;
+   promotion policy;
+   // the number of children promoted by top_k, at least 1
+   int top_k;
+   // the relative tolerance of optimistic_bound
+   double tolerance;
+};
+
+/*
+ * FidelityScheduler
+ *
+ * evaluates the children of a generation (see evaluation_func) first with a
+ * KusiakLayoutEvaluator which only computes the most important directions,
+ * then promotes the children chosen by the policy to the exact evaluator.
+ * the other children are removed, so that only exactly evaluated children
+ * can enter the population; at least one child is always promoted. after
+ * the low-fidelity generations every child is evaluated exactly
+ *
+ * approximate evaluations don't count against the evaluation budget, and
+ * the scheduler must be created before the run starts, since initializing
+ * its evaluator resets the global evaluation counter
+ */
+class FidelityScheduler {
+public:
+   FidelityScheduler(std::shared_ptr<const CompiledScenario> scenario,
+                     const fidelity_config& config);
+
+   void evaluate(WindFarmLayoutEvaluator& evaluator, std::vector<individual>& children,
+                 int generation);
+
+   int low_evaluations() const { return low_count; }
+   int exact_evaluations() const { return exact_count; }
+   // the largest relative error of the low-fidelity cost of a promoted child
+   double max_error() const { return max_relative_error; }
+
+private:
+   KusiakLayoutEvaluator low;
+   fidelity_config config;
+   // the best exact fitness evaluated by the scheduler
+   double best_exact;
+   double max_relative_error;
+   int low_count;
+   int exact_count;
+};
+
+#endif
@@ -1,12 +1,24 @@
 #include <random>
 #include <vector>
 #include <fstream>
+#include "API/WindFarmLayoutEvaluator.h"
 #include "functions.hpp"
+#include "instrumentation.hpp"
 
 namespace functions {
+   namespace {
+      // whether evaluate_individual copies the wake free ratios
+      bool keep_ratios = false;
+   }
+
+   void keep_wake_free_ratios(bool keep) {
+      keep_ratios = keep;
+   }
+
    bool turbine_collides(double x, double y,
                          Scenario &scenario,
                          std::vector<coordinate> &layout){
+       BBO_COUNT(collision_checks, 1);
     
        // We check first whether the coordinate collides with an obstacle
        if (functions::coordinateCollidesWithObstacles(x, y, scenario)){
@@ -38,7 +50,7 @@ namespace functions {
     bool coordinateCollidesWithObstacles(double x, double y, Scenario& scenario){
         // We check whether this coordinate collide with a given obstacle
         for (int o = 0; o < scenario.obstacles.rows; o++) {
-            Matrix<double> matObstacles = scenario.obstacles;
+            const Matrix<double>& matObstacles = scenario.obstacles;
             // If somehow the position of a turbine is within the range
             // of an obstacle, then it collides, and it's an invalid turbine
             double xmin = matObstacles.get(o, 0);
@@ -95,7 +107,7 @@ namespace functions {
                 file >> layout_size;
                 indiv.fitness = fitness;
                 for (int j = 0; j < layout_size; ++j){
-                    coordinate coord;
+                    coordinate coord{};
                     file >> coord.x >> coord.y;
                     indiv.layout.push_back(coord);
                 }
@@ -145,6 +157,30 @@ namespace functions {
     }
 
 
+   double evaluate_individual(WindFarmLayoutEvaluator &evaluator,
+                              individual &indiv) {
+      BBO_COUNT(evaluations, 1);
+      Matrix<double> mat_layout = individual_to_matrix<double>(indiv.layout);
+      indiv.fitness = evaluator.evaluate(&mat_layout);
+      if (!keep_ratios || indiv.layout.empty())
+         return indiv.fitness;
+      // keep the wake free ratio of each turbine for guided operators
+      thread_local std::vector<double> ratios;
+      ratios.resize(indiv.layout.size());
+      if (evaluator.copyTurbineFitnesses(ratios.data())) {
+         for (std::size_t i = 0; i < indiv.layout.size(); ++i) {
+            indiv.layout[i].wake_free_ratio = ratios[i];
+         }
+      } else {
+         // an invalid layout has no ratios, the old ones belong to
+         // another layout
+         for (auto& coord : indiv.layout) {
+            coord.wake_free_ratio = 0.0;
+         }
+      }
+      return indiv.fitness;
+   }
+
    bool compare_fitness(const individual &indiv,const individual &indiv2) {
       return (indiv.fitness > indiv2.fitness);
    }
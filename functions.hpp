@@ -10,6 +10,8 @@
 #include "structures.hpp"
 #include "scenario.hpp"
 
+class WindFarmLayoutEvaluator;
+
 namespace functions {
     /* turbine_collides
      *
@@ -66,6 +68,35 @@ namespace functions {
     template<typename T>
     Matrix<T> individual_to_matrix(std::vector<coordinate> &vector);
 
+    /* keep_wake_free_ratios
+     *
+     * Whether evaluate_individual stores the wake free ratio of each turbine
+     * in its coordinate. Only the guided operators read them, so they aren't
+     * copied unless this is set (before the run starts)
+     *
+     * params:
+     *     bool keep : true to store the ratios
+     */
+    void keep_wake_free_ratios(bool keep);
+
+    /* evaluate_individual
+     *
+     * This function evaluates the layout of an individual and stores the
+     * result in its fitness, and, if keep_wake_free_ratios is set, the wake
+     * free ratio of each turbine in its coordinate (0, i.e. not evaluated,
+     * if the layout was invalid). Every evaluation of the algorithm should
+     * go through here, so that they are all counted the same way
+     *
+     * params:
+     *     WindFarmLayoutEvaluator &evaluator : the evaluator of the api
+     *     individual &indiv : the individual to evaluate
+     *
+     * returns:
+     *     double : the fitness of the individual
+     */
+    double evaluate_individual(WindFarmLayoutEvaluator &evaluator,
+                               individual &indiv);
+
     /* compare_fitness
      *
      * This function compares the fitnesses of two individuals
@@ -0,0 +1,108 @@
+#include "hilbert.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace hilbert {
+   namespace {
+      // the cells per side of the curve
+      const std::uint32_t SIDE = 1u << 16;
+      // above this many descents a full sort is cheaper than merging the runs
+      const std::size_t MAX_DESCENTS = 8;
+
+      std::uint32_t cell(double v, double extent) {
+         double c = extent > 0.0 ? v / extent * SIDE : 0.0;
+         if (c < 0.0)
+            return 0;
+         if (c >= SIDE - 1)
+            return SIDE - 1;
+         return static_cast<std::uint32_t>(c);
+      }
+   }
+
+   std::uint32_t key(double x, double y, const Scenario& scenario) {
+      // the same scale on both axes, so the curve keeps its locality
+      double extent = std::max(scenario.width, scenario.height);
+      std::uint32_t cx = cell(x, extent);
+      std::uint32_t cy = cell(y, extent);
+      std::uint32_t d = 0;
+      for (std::uint32_t s = SIDE / 2; s > 0; s /= 2) {
+         std::uint32_t rx = (cx & s) > 0;
+         std::uint32_t ry = (cy & s) > 0;
+         d += s * s * ((3 * rx) ^ ry);
+         // rotate the quadrant, so the sub-curve is in standard orientation
+         if (ry == 0) {
+            if (rx == 1) {
+               cx = SIDE - 1 - cx;
+               cy = SIDE - 1 - cy;
+            }
+            std::swap(cx, cy);
+         }
+      }
+      return d;
+   }
+
+   void order(std::vector<coordinate>& layout, const Scenario& scenario) {
+      // the keys are computed once, the buffer is kept between the calls
+      thread_local std::vector<std::pair<std::uint32_t, coordinate>> keyed;
+      keyed.clear();
+      std::size_t descents = 0;
+      for (auto& coord : layout) {
+         keyed.push_back({ key(coord.x, coord.y, scenario), coord });
+         if (keyed.size() > 1 && keyed.back().first < keyed[keyed.size() - 2].first)
+            ++descents;
+      }
+      if (descents == 0)
+         return;
+      auto by_key = [](const std::pair<std::uint32_t, coordinate>& a,
+                       const std::pair<std::uint32_t, coordinate>& b) {
+         return a.first < b.first;
+      };
+      if (descents <= MAX_DESCENTS) {
+         // merge the sorted runs one after the other into the first
+         auto run_end = keyed.begin() + 1;
+         while (run_end != keyed.end() && !by_key(*run_end, *(run_end - 1)))
+            ++run_end;
+         while (run_end != keyed.end()) {
+            auto next_end = run_end + 1;
+            while (next_end != keyed.end() && !by_key(*next_end, *(next_end - 1)))
+               ++next_end;
+            std::inplace_merge(keyed.begin(), run_end, next_end, by_key);
+            run_end = next_end;
+         }
+      } else {
+         std::sort(keyed.begin(), keyed.end(), by_key);
+      }
+      for (std::size_t i = 0; i < layout.size(); ++i) {
+         layout[i] = keyed[i].second;
+      }
+   }
+
+   initialization_func ordered(initialization_func initialize) {
+      return [initialize](WindFarmLayoutEvaluator& evaluator, Scenario& scenario) {
+         auto population = initialize(evaluator, scenario);
+         for (auto& indiv : population) {
+            order(indiv.layout, scenario);
+         }
+         return population;
+      };
+   }
+
+   recombination_func ordered(recombination_func recombine) {
+      return [recombine](const std::vector<std::vector<individual>::iterator>& parents,
+                         Scenario& scenario) {
+         auto children = recombine(parents, scenario);
+         for (auto& child : children) {
+            order(child.layout, scenario);
+         }
+         return children;
+      };
+   }
+
+   mutation_func ordered(mutation_func mutate) {
+      return [mutate](individual& indiv, Scenario& scenario) {
+         mutate(indiv, scenario);
+         order(indiv.layout, scenario);
+      };
+   }
+}
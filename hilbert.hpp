@@ -0,0 +1,51 @@
+/*
+ * hilbert.hpp
+ *
+ * contains the ordering of layouts along a Hilbert curve, so that turbines
+ * which are close in the farm are close in memory
+ */
+#ifndef BBO_HILBERT_HPP
+#define BBO_HILBERT_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "evolutionary_algorithm.hpp"
+#include "scenario.hpp"
+#include "structures.hpp"
+
+namespace hilbert {
+   /*
+    * hilbert::key
+    *
+    * returns:
+    *    the position of (x, y) along a Hilbert curve through 2^16 x 2^16
+    *    cells over the square which covers the farm, positions outside of
+    *    the farm are clamped to its border
+    */
+   std::uint32_t key(double x, double y, const Scenario& scenario);
+
+   /*
+    * hilbert::order
+    *
+    * sorts a layout by key. layouts which consist of a few sorted runs (as
+    * the child of a crossover of ordered parents, or a layout where a few
+    * turbines moved) are merged run by run in about linear time
+    */
+   void order(std::vector<coordinate>& layout, const Scenario& scenario);
+
+   /*
+    * hilbert::ordered
+    *
+    * wrap an operator so that the layouts it returns or changes are ordered,
+    * so that every layout of a run stays ordered. the operators themselves
+    * don't keep the order, the wrapper sorts each layout again after every
+    * call; as their output is mostly made of sorted runs, this post-pass
+    * costs about linear time (see order)
+    */
+   initialization_func ordered(initialization_func initialize);
+   recombination_func ordered(recombination_func recombine);
+   mutation_func ordered(mutation_func mutate);
+}
+
+#endif
@@ -1,10 +1,14 @@
+#include <algorithm>
+#include <cmath>
 #include <random>
 #include <vector>
 #include <stdlib.h>
 #include <time.h>
 
 #include "random.hpp"
+#include "spatial_index.hpp"
 #include "initialization.hpp"
+#include "instrumentation.hpp"
 #include "API/Matrix.hpp"
 
 namespace initialization {
@@ -29,7 +33,7 @@ namespace initialization {
 
         std::vector<individual> population;
         individual indiv;
-        coordinate coord;
+        coordinate coord{};
 
         for (int j = 0; j < pop_size;j++){
             //initiate layout (coordinates)
@@ -69,43 +73,19 @@ namespace initialization {
      */
    void replace_violations(std::vector<individual> &population, Scenario &scenario) {
         double radius = scenario.R * 8.0001; //distance must be radius*8
-        //population.at(i).layout.at(j).x
-        //thirst loop to pick an individual, second to pick a coordinate to be checked
-        //third loop to compare the chosen coordinate with all other coordinates
-        //within the individuals layout
-        for (int i = 0; i < population.size(); i++) {
-            for (int j = 0; j < population.at(i).layout.size(); j++){
-                for (int coord = 0; coord < population.at(i).layout.size();) {
-                    //preventing the comparison to the coordinate itself
-                    if (j == coord) {
-                        coord++;
-                        continue;
-                    }
-                    // checks if the x and y values are NOT within the violation distance
-                    // off the corresponding coordinate
-                    // Both values, x and y, must be within that range
-                    // either under or above the given coordinate
-                    // Each "successfull" if branch proves that no violation exists
-                    // for this pair, and thereby continues to the next coordinate /
-                    // iteration
-                    if (turbine_distance(population[i].layout[j],
-                                         population[i].layout[coord]) > radius) {
-                       coord++;
-                       continue;
-                    }
-
-                    // violation occured:
-                    // The violation is proven if no if branch above is triggered
-                    // the violating coordinate will be randomly replaced, and all
-                    // other coordinates within the individual will be checked against
-                    // the new one (coord = 0)
-                    population[i].layout[j].x = scenario.width * (double) rand()
-                       / (double) RAND_MAX;
-                    population[i].layout[j].y = scenario.height * (double) rand()
-                       / (double) RAND_MAX;
-                    coord = 0;
+        // the coordinates which were already checked, in a grid, so every
+        // coordinate is only compared with its neighbours
+        SpatialIndex checked(scenario.width, scenario.height, radius);
+        for (auto& indiv : population) {
+            checked.clear();
+            for (auto& coord : indiv.layout) {
+                // a violating coordinate is randomly replaced until it keeps
+                // its distance to all coordinates checked before it
+                while (checked.collides(coord.x, coord.y)) {
+                    coord.x = scenario.width * (double) rand() / (double) RAND_MAX;
+                    coord.y = scenario.height * (double) rand() / (double) RAND_MAX;
                 }
-
+                checked.insert(coord);
             }
         }
     }
@@ -124,16 +104,9 @@ namespace initialization {
     */
     void evaluate_population(WindFarmLayoutEvaluator &evaluator,
                              std::vector<individual> &population) {
-        //cast to Matrix
-        Matrix<double> test_matrix(population.at(0).layout.size(),2);
-        
-        for(int j = 0; j < population.size(); j++) {       
-            for(int i = 0; i < population.at(j).layout.size(); i++) {
-                test_matrix.set(i,0,population.at(j).layout.at(i).x);
-                test_matrix.set(i,1,population.at(j).layout.at(i).y);
-            }
-            population.at(j).fitness = evaluator.evaluate(&test_matrix);        
-        }                
+        for (auto& indiv : population) {
+            functions::evaluate_individual(evaluator, indiv);
+        }
     }
    
     individual create_individual_2(WindFarmLayoutEvaluator &evaluator,
@@ -187,15 +160,17 @@ namespace initialization {
                 struct coordinate coord = {
                     x, //x coordinate
                     y, //y coordinate
+                    0.0, //not evaluated yet
                 };
 
                 indiv.layout.push_back(coord);
                 count++;
+            } else {
+                BBO_COUNT(collision_retries, 1);
             }
         };
         // We calculate the fitness of the individual, or the layout
-        Matrix<double> mat_layout = functions::individual_to_matrix<double>(indiv.layout);
-        indiv.fitness = evaluator.evaluate(&mat_layout);
+        functions::evaluate_individual(evaluator, indiv);
         return indiv;
     }
 
@@ -213,4 +188,180 @@ namespace initialization {
 
             return population;
     }
+
+    std::vector<coordinate> poisson_disk_layout(Scenario &scenario,
+                                                std::mt19937 &engine) {
+        // the same safety margin as create_individual_2
+        double min_distance = 8.0 * scenario.R * 1.000001;
+        // the number of candidates around an active turbine before it
+        // is retired, and of random seeds tried once no turbine is active
+        const int CANDIDATES = 30;
+        const int SEEDS = 30;
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        SpatialIndex index(scenario.width, scenario.height, min_distance);
+        // the turbines which may still have free space around them
+        std::vector<int> active;
+
+        auto valid = [&](double x, double y) {
+            return x >= 0.0 && x <= scenario.width &&
+                   y >= 0.0 && y <= scenario.height &&
+                   !functions::coordinateCollidesWithObstacles(x, y, scenario) &&
+                   !index.collides(x, y);
+        };
+        auto place = [&](double x, double y) {
+            active.push_back(index.size());
+            index.insert({ x, y, 0.0 });
+        };
+
+        // obstacles may split the farm, so the sampling is seeded again
+        // until random seeds only land next to placed turbines
+        for (int seed = 0; seed < SEEDS; ++seed) {
+            double x = unit(engine) * scenario.width;
+            double y = unit(engine) * scenario.height;
+            if (!valid(x, y)) {
+                BBO_COUNT(collision_retries, 1);
+                continue;
+            }
+            place(x, y);
+            seed = 0;
+            while (!active.empty()) {
+                std::size_t a = std::min<std::size_t>(unit(engine) * active.size(),
+                                                      active.size() - 1);
+                coordinate center = index.layout()[active[a]];
+                bool found = false;
+                // candidates in the annulus [min_distance, 2 * min_distance)
+                for (int c = 0; c < CANDIDATES && !found; ++c) {
+                    double angle = unit(engine) * 2.0 * M_PI;
+                    double r = min_distance * (1.0 + unit(engine));
+                    double cx = center.x + r * std::cos(angle);
+                    double cy = center.y + r * std::sin(angle);
+                    if (valid(cx, cy)) {
+                        place(cx, cy);
+                        found = true;
+                    }
+                }
+                if (!found) {
+                    active[a] = active.back();
+                    active.pop_back();
+                }
+            }
+        }
+        return index.layout();
+    }
+
+    std::vector<coordinate> random_layout(Scenario &scenario, std::mt19937 &engine) {
+        // the same constraints and sizes as create_individual_2
+        double min_distance = 8.0 * scenario.R * 1.000001;
+        std::uniform_int_distribution<int> count(3 * scenario.max_turbines / 4,
+                                                 scenario.max_turbines);
+        std::uniform_real_distribution<double> wdist(0.0, scenario.width);
+        std::uniform_real_distribution<double> hdist(0.0, scenario.height);
+        std::size_t n_turbines = count(engine);
+        SpatialIndex index(scenario.width, scenario.height, min_distance);
+        while (index.size() < n_turbines) {
+            double x = wdist(engine);
+            double y = hdist(engine);
+            if (functions::coordinateCollidesWithObstacles(x, y, scenario) ||
+                index.collides(x, y)) {
+                BBO_COUNT(collision_retries, 1);
+                continue;
+            }
+            index.insert({ x, y, 0.0 });
+        }
+        return index.layout();
+    }
+
+    std::vector<coordinate> sized_poisson_disk_layout(Scenario &scenario,
+                                                      std::mt19937 &engine) {
+        std::vector<coordinate> layout = poisson_disk_layout(scenario, engine);
+        // keep as many turbines as create_individual_2 would place, a random
+        // subset of a valid layout is still valid
+        std::uniform_int_distribution<int> count(3 * scenario.max_turbines / 4,
+                                                 scenario.max_turbines);
+        std::size_t n_turbines = count(engine);
+        if (layout.size() > n_turbines) {
+            std::shuffle(layout.begin(), layout.end(), engine);
+            layout.resize(n_turbines);
+        }
+        return layout;
+    }
+
+    individual create_individual_3(WindFarmLayoutEvaluator &evaluator,
+                                   Scenario &scenario,
+                                   std::mt19937 &engine) {
+        individual indiv;
+        indiv.layout = sized_poisson_disk_layout(scenario, engine);
+        functions::evaluate_individual(evaluator, indiv);
+        return indiv;
+    }
+
+    std::vector<individual> initialization_3(WindFarmLayoutEvaluator &evaluator,
+                                             Scenario &scenario,
+                                             int num_population) {
+        std::random_device device;
+        std::mt19937 engine(device());
+        std::vector<individual> population;
+        for (int i = 0; i < num_population; ++i) {
+            population.push_back(create_individual_3(evaluator, scenario, engine));
+        }
+        return population;
+    }
+
+    std::vector<coordinate> sampled_layout(const WakeField &field,
+                                           Scenario &scenario,
+                                           std::mt19937 &engine) {
+        // the same constraints and sizes as create_individual_2
+        const int ATTEMPTS = 64;
+        double min_distance = 8.0 * scenario.R * 1.000001;
+        std::uniform_int_distribution<int> count(3 * scenario.max_turbines / 4,
+                                                 scenario.max_turbines);
+        std::size_t n_turbines = count(engine);
+        SpatialIndex index(scenario.width, scenario.height, min_distance);
+        WakeShadow shadow(field);
+        bool full = false;
+        while (index.size() < n_turbines && !full) {
+            double x;
+            double y;
+            // the number of positions drawn for this turbine
+            int attempts = 0;
+            bool valid = false;
+            while (!valid && attempts < ATTEMPTS) {
+                ++attempts;
+                shadow.draw(engine, x, y);
+                valid = !functions::coordinateCollidesWithObstacles(x, y, scenario) &&
+                        !index.collides(x, y);
+            }
+            BBO_RETRIES(attempts - (valid ? 1 : 0));
+            if (!valid) {
+                full = true;
+                continue;
+            }
+            index.insert({ x, y, 0.0 });
+            shadow.add(index.layout().back());
+        }
+        return index.layout();
+    }
+
+    individual create_individual_4(const WakeField &field,
+                                   WindFarmLayoutEvaluator &evaluator,
+                                   Scenario &scenario,
+                                   std::mt19937 &engine) {
+        individual indiv;
+        indiv.layout = sampled_layout(field, scenario, engine);
+        functions::evaluate_individual(evaluator, indiv);
+        return indiv;
+    }
+
+    std::vector<individual> initialization_4(const WakeField &field,
+                                             WindFarmLayoutEvaluator &evaluator,
+                                             Scenario &scenario,
+                                             int num_population) {
+        std::random_device device;
+        std::mt19937 engine(device());
+        std::vector<individual> population;
+        for (int i = 0; i < num_population; ++i) {
+            population.push_back(create_individual_4(field, evaluator, scenario, engine));
+        }
+        return population;
+    }
 }
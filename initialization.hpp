@@ -6,13 +6,20 @@
 #ifndef BBO_INITIALIZATION_HPP
 #define BBO_INITIALIZATION_HPP
 
+#include <functional>
+#include <random>
+
 #include "API/WindFarmLayoutEvaluator.h"
 #include "API/Matrix.hpp"
 #include "functions.hpp"
 #include "structures.hpp"
 #include "scenario.hpp"
+#include "wake_field.hpp"
 
 namespace initialization {
+    // the signature of a function which draws a layout from an engine
+    using layout_func = std::function<std::vector<coordinate>(Scenario&, std::mt19937&)>;
+
      /* initialization_1
      *
      * This function takes  the relevant layout data as parameter and produces
@@ -101,6 +108,98 @@ namespace initialization {
     individual create_individual_2(WindFarmLayoutEvaluator &evaluator,
                                    Scenario &scenario);
 
+    /* poisson_disk_layout
+     *
+     * Creates a maximal valid layout with Bridson's Poisson-disk sampling:
+     * new turbines are drawn in the ring between one and two minimal
+     * distances around an active turbine, which is retired once 30 draws
+     * fail. A grid (see SpatialIndex) makes each check O(1), so the layout
+     * is built in O(n) instead of retrying uniform positions near the max
+     * density. Positions in obstacles are rejected, and the sampling is
+     * seeded again for parts of the farm separated by obstacles.
+     *
+     * params:
+     *     Scenario &scenario : the farm and its obstacles
+     *     std::mt19937 &engine : the source of randomness
+     *
+     * returns:
+     *     vector<coordinate> : the layout, without fitnesses
+     */
+    std::vector<coordinate> poisson_disk_layout(Scenario &scenario,
+                                                std::mt19937 &engine);
+
+    /* sized_poisson_disk_layout
+     *
+     * A Poisson-disk layout, reduced to a random subset of the size
+     * create_individual_2 would use.
+     */
+    std::vector<coordinate> sized_poisson_disk_layout(Scenario &scenario,
+                                                      std::mt19937 &engine);
+
+    /* random_layout
+     *
+     * The layout of create_individual_2 (uniform positions, colliding ones
+     * are drawn again), but drawn from the given engine and checked against
+     * a SpatialIndex instead of every placed turbine.
+     */
+    std::vector<coordinate> random_layout(Scenario &scenario, std::mt19937 &engine);
+
+    /* create_individual_3
+     *
+     * Creates an individual from sized_poisson_disk_layout and evaluates it.
+     */
+    individual create_individual_3(WindFarmLayoutEvaluator &evaluator,
+                                   Scenario &scenario,
+                                   std::mt19937 &engine);
+
+    /* initialization_3
+     *
+     * The same as initialization_2, but the individuals are created by
+     * create_individual_3, which never has to retry colliding positions.
+     */
+    std::vector<individual> initialization_3(WindFarmLayoutEvaluator &evaluator,
+                                             Scenario &scenario,
+                                             int num_population);
+
+    /* sampled_layout
+     *
+     * A layout of the size create_individual_2 would use, but each turbine
+     * is drawn in proportion to the yield left over by the turbines placed
+     * before it (see WakeShadow) instead of uniformly. At most 64 positions
+     * are drawn per turbine, the layout stops growing once none of them is
+     * valid.
+     *
+     * params:
+     *     const WakeField &field : the wind exposure of the scenario
+     *     Scenario &scenario : the farm and its obstacles
+     *     std::mt19937 &engine : the source of randomness
+     *
+     * returns:
+     *     vector<coordinate> : the layout, without fitnesses
+     */
+    std::vector<coordinate> sampled_layout(const WakeField &field,
+                                           Scenario &scenario,
+                                           std::mt19937 &engine);
+
+    /* create_individual_4
+     *
+     * Creates an individual from sampled_layout and evaluates it.
+     */
+    individual create_individual_4(const WakeField &field,
+                                   WindFarmLayoutEvaluator &evaluator,
+                                   Scenario &scenario,
+                                   std::mt19937 &engine);
+
+    /* initialization_4
+     *
+     * The same as initialization_2, but the individuals are created by
+     * create_individual_4, so their turbines avoid each other's wakes.
+     */
+    std::vector<individual> initialization_4(const WakeField &field,
+                                             WindFarmLayoutEvaluator &evaluator,
+                                             Scenario &scenario,
+                                             int num_population);
+
 }
 
 
@@ -0,0 +1,193 @@
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "instrumentation.hpp"
+
+namespace instrumentation {
+   namespace {
+      const int NUM_PHASES = static_cast<int>(phase::count);
+      const int NUM_COUNTERS = static_cast<int>(counter::count);
+
+      const char* phase_names[NUM_PHASES] = {
+         "initialize", "select", "recombine", "mutate",
+         "remove_illegal", "evaluate", "replace"
+      };
+      const char* counter_names[NUM_COUNTERS] = {
+         "collision_checks", "collision_retries", "evaluations",
+         "surrogate_rejections", "low_fidelity_evaluations", "dropped_turbines"
+      };
+      // bucket b > 0 holds [2^(b-1), 2^b) retries, the last one everything above
+      const int NUM_BUCKETS = 16;
+
+      // accumulated since the last generation report
+      std::atomic<long long> generation_ns[NUM_PHASES];
+      std::atomic<long long> generation_counts[NUM_COUNTERS];
+      // accumulated since the start of the program
+      std::atomic<long long> total_ns[NUM_PHASES];
+      std::atomic<long long> total_counts[NUM_COUNTERS];
+      // the retry histograms and the most retries of a single placement
+      std::atomic<long long> generation_retries[NUM_BUCKETS];
+      std::atomic<long long> total_retries[NUM_BUCKETS];
+      std::atomic<long long> generation_max_retries(0);
+      std::atomic<long long> total_max_retries(0);
+
+      // one complete ("ph":"X") event of the trace file
+      struct trace_event {
+         phase p;
+         long long start_us;
+         long long duration_us;
+         int tid;
+      };
+      std::atomic<bool> trace_enabled(false);
+      std::string trace_file;
+      std::mutex trace_mutex;
+      std::vector<trace_event> trace_events;
+      std::map<std::thread::id, int> trace_tids;
+      // all trace timestamps are relative to this point
+      const std::chrono::steady_clock::time_point epoch =
+         std::chrono::steady_clock::now();
+
+      double to_ms(long long ns) {
+         return ns / 1.0e6;
+      }
+
+      int bucket(long long retries) {
+         int b = 0;
+         while (retries > 0 && b < NUM_BUCKETS - 1) {
+            retries >>= 1;
+            ++b;
+         }
+         return b;
+      }
+
+      void raise_max(std::atomic<long long>& max, long long value) {
+         long long current = max;
+         while (current < value && !max.compare_exchange_weak(current, value)) {
+         }
+      }
+
+      // prints the non-empty buckets, resetting them if reset is true
+      void write_retries(std::atomic<long long>* buckets, std::atomic<long long>& max,
+                         bool reset, std::ostream& out) {
+         out << "retries";
+         for (int b = 0; b < NUM_BUCKETS; ++b) {
+            long long n = reset ? buckets[b].exchange(0) : buckets[b].load();
+            if (n == 0)
+               continue;
+            long long low = b == 0 ? 0 : 1LL << (b - 1);
+            out << ' ' << low;
+            if (b == NUM_BUCKETS - 1) {
+               out << '+';
+            } else if (b > 1) {
+               out << '-' << (1LL << b) - 1;
+            }
+            out << ':' << n;
+         }
+         out << " max " << (reset ? max.exchange(0) : max.load());
+      }
+
+      void write_trace() {
+         std::lock_guard<std::mutex> lock(trace_mutex);
+         std::ofstream file(trace_file);
+         file << "{\"traceEvents\":[\n";
+         for (std::size_t i = 0; i < trace_events.size(); ++i) {
+            auto& event = trace_events[i];
+            file << "{\"name\":\"" << phase_names[static_cast<int>(event.p)]
+                 << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.tid
+                 << ",\"ts\":" << event.start_us
+                 << ",\"dur\":" << event.duration_us << "}"
+                 << (i + 1 < trace_events.size() ? ",\n" : "\n");
+         }
+         file << "]}\n";
+         file.close();
+         std::cout << "Trace written to " << trace_file << std::endl;
+      }
+   }
+
+   void add_time(phase p, std::chrono::steady_clock::time_point start,
+                 std::chrono::steady_clock::time_point end) {
+      using std::chrono::duration_cast;
+      using std::chrono::nanoseconds;
+      using std::chrono::microseconds;
+      long long ns = duration_cast<nanoseconds>(end - start).count();
+      generation_ns[static_cast<int>(p)] += ns;
+      total_ns[static_cast<int>(p)] += ns;
+
+      if (trace_enabled) {
+         std::lock_guard<std::mutex> lock(trace_mutex);
+         auto id = std::this_thread::get_id();
+         auto tid = trace_tids.find(id);
+         if (tid == trace_tids.end()) {
+            tid = trace_tids.insert({ id, static_cast<int>(trace_tids.size()) + 1 }).first;
+         }
+         trace_events.push_back({
+            p,
+            duration_cast<microseconds>(start - epoch).count(),
+            duration_cast<microseconds>(end - start).count(),
+            tid->second
+         });
+      }
+   }
+
+   void add_count(counter c, long long n) {
+      generation_counts[static_cast<int>(c)] += n;
+      total_counts[static_cast<int>(c)] += n;
+   }
+
+   void add_retries(long long retries) {
+      add_count(counter::collision_retries, retries);
+      int b = bucket(retries);
+      ++generation_retries[b];
+      ++total_retries[b];
+      raise_max(generation_max_retries, retries);
+      raise_max(total_max_retries, retries);
+   }
+
+   void report_generation(int generation, std::ostream& out) {
+      std::streamsize precision = out.precision();
+      out << "[gen " << generation << "]" << std::fixed << std::setprecision(2);
+      for (int p = 0; p < NUM_PHASES; ++p) {
+         out << ' ' << phase_names[p] << ' ' << to_ms(generation_ns[p].exchange(0)) << "ms";
+      }
+      out << " |";
+      for (int c = 0; c < NUM_COUNTERS; ++c) {
+         out << ' ' << counter_names[c] << ' ' << generation_counts[c].exchange(0);
+      }
+      out << " | ";
+      write_retries(generation_retries, generation_max_retries, true, out);
+      out << std::defaultfloat << std::setprecision(precision) << std::endl;
+   }
+
+   void report_total(std::ostream& out) {
+      std::streamsize precision = out.precision();
+      out << "=== Instrumentation totals ===\n" << std::fixed << std::setprecision(2);
+      for (int p = 0; p < NUM_PHASES; ++p) {
+         out << phase_names[p] << ": " << to_ms(total_ns[p]) << "ms\n";
+      }
+      for (int c = 0; c < NUM_COUNTERS; ++c) {
+         out << counter_names[c] << ": " << total_counts[c] << '\n';
+      }
+      write_retries(total_retries, total_max_retries, false, out);
+      out << '\n';
+      out << std::defaultfloat << std::setprecision(precision) << std::flush;
+      if (trace_enabled) {
+         write_trace();
+      }
+   }
+
+   void enable_trace(const std::string& file_name) {
+#ifdef BBO_INSTRUMENTATION
+      std::lock_guard<std::mutex> lock(trace_mutex);
+      trace_file = file_name;
+      trace_enabled = true;
+#else
+      std::cerr << "WARNING: built without BBO_INSTRUMENTATION, no trace will be written to "
+                << file_name << std::endl;
+#endif
+   }
+}
@@ -0,0 +1,143 @@
+/*
+ * instrumentation.hpp
+ *
+ * contains low-overhead timers and counters for the hot paths of the
+ * evolutionary algorithm
+ *
+ * the BBO_* macros below compile to nothing unless BBO_INSTRUMENTATION is
+ * defined (configure with cmake -DBBO_INSTRUMENTATION=ON), so the hot paths
+ * don't pay anything for them in a normal build
+ */
+#ifndef BBO_INSTRUMENTATION_HPP
+#define BBO_INSTRUMENTATION_HPP
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+namespace instrumentation {
+   // the phases of a generation which are timed
+   enum class phase {
+      initialize,
+      select,
+      recombine,
+      mutate,
+      remove_illegal,
+      evaluate,
+      replace,
+      count // number of phases, keep last
+   };
+
+   // the events which are counted
+   enum class counter {
+      collision_checks,  // calls of functions::turbine_collides
+      collision_retries, // rejected positions in the turbine_collides loops
+      evaluations,       // calls of the evaluator
+      surrogate_rejections, // children the surrogate kept from the evaluator
+      low_fidelity_evaluations, // approximate evaluations of the fidelity schedule
+      dropped_turbines,  // turbines a bounded mutation found no place for
+      count // number of counters, keep last
+   };
+
+   /*
+    * instrumentation::add_time
+    *
+    * adds the wall time of one pass through a phase
+    * safe to call from multiple threads
+    *
+    * parameters:
+    *    p - the phase
+    *    start - when the phase was entered
+    *    end - when the phase was left
+    */
+   void add_time(phase p, std::chrono::steady_clock::time_point start,
+                 std::chrono::steady_clock::time_point end);
+
+   /*
+    * instrumentation::add_count
+    *
+    * increases a counter, safe to call from multiple threads
+    */
+   void add_count(counter c, long long n);
+
+   /*
+    * instrumentation::add_retries
+    *
+    * records the rejected positions of one placed turbine in a histogram
+    * with power of two buckets (0, 1, 2-3, 4-7, ...) and in the
+    * collision_retries counter. the reports print the non-empty buckets and
+    * the maximum, which bounds the latency of a placement
+    * safe to call from multiple threads
+    */
+   void add_retries(long long retries);
+
+   /*
+    * instrumentation::report_generation
+    *
+    * prints a one line summary of the times and counters accumulated since
+    * the last report, then starts a new accumulation
+    *
+    * parameters:
+    *    generation - the generation which just finished
+    *    out - the stream to write to
+    */
+   void report_generation(int generation, std::ostream& out);
+
+   /*
+    * instrumentation::report_total
+    *
+    * prints the times and counters accumulated since the start of the program
+    * and writes the trace file if tracing was enabled
+    */
+   void report_total(std::ostream& out);
+
+   /*
+    * instrumentation::enable_trace
+    *
+    * records every timed phase as a complete event and writes them in the
+    * Chrome trace event format (readable by chrome://tracing and Perfetto)
+    * to file_name when report_total is called
+    */
+   void enable_trace(const std::string& file_name);
+
+   /*
+    * scoped_timer
+    *
+    * adds the time between its construction and destruction to a phase
+    */
+   class scoped_timer {
+   public:
+      explicit scoped_timer(phase p)
+         : p(p), start(std::chrono::steady_clock::now()) {}
+      ~scoped_timer() { add_time(p, start, std::chrono::steady_clock::now()); }
+
+      scoped_timer(const scoped_timer&) = delete;
+      scoped_timer& operator=(const scoped_timer&) = delete;
+
+   private:
+      phase p;
+      std::chrono::steady_clock::time_point start;
+   };
+}
+
+#ifdef BBO_INSTRUMENTATION
+#define BBO_CONCAT_IMPL(a, b) a##b
+#define BBO_CONCAT(a, b) BBO_CONCAT_IMPL(a, b)
+// times the rest of the enclosing scope as the given phase
+#define BBO_TIME_PHASE(p) \
+   instrumentation::scoped_timer BBO_CONCAT(bbo_timer_, __LINE__)(instrumentation::phase::p)
+// increases the given counter by n
+#define BBO_COUNT(c, n) instrumentation::add_count(instrumentation::counter::c, (n))
+// records the retries of one placement in the retry histogram
+#define BBO_RETRIES(n) instrumentation::add_retries(n)
+#define BBO_REPORT_GENERATION(g) instrumentation::report_generation((g), std::cout)
+#define BBO_REPORT_TOTAL() instrumentation::report_total(std::cout)
+#else
+#define BBO_TIME_PHASE(p)
+#define BBO_COUNT(c, n)
+#define BBO_RETRIES(n)
+#define BBO_REPORT_GENERATION(g)
+#define BBO_REPORT_TOTAL()
+#endif
+
+#endif
@@ -0,0 +1,393 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <limits>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "API/WindFarmLayoutEvaluator.h"
+#include "functions.hpp"
+#include "instrumentation.hpp"
+#include "island_model.hpp"
+#include "replacement.hpp"
+#include "scenario.hpp"
+#include "spsc_queue.hpp"
+
+namespace {
+   // the largest migrant datagram which is received between processes
+   const std::size_t MAX_MESSAGE_SIZE = 1 << 20;
+
+   // the state of one island
+   struct island {
+      int index;
+      std::unique_ptr<WindFarmLayoutEvaluator> evaluator;
+      std::vector<individual> population;
+      // sends a migrant to one neighbour, returns false if it was dropped
+      std::vector<std::function<bool(const individual&)>> outgoing;
+      // receives a migrant from one neighbour, returns false if there is none
+      std::vector<std::function<bool(individual&)>> incoming;
+      double initial_fittest;
+      double fittest;
+   };
+
+   // the (from, to) pairs of islands which exchange migrants
+   std::vector<std::pair<int, int>> migration_edges(topology links, int islands) {
+      std::vector<std::pair<int, int>> edges;
+      for (int from = 0; from < islands; ++from) {
+         if (links == topology::ring) {
+            if (islands > 1) {
+               edges.push_back({ from, (from + 1) % islands });
+            }
+         } else {
+            for (int to = 0; to < islands; ++to) {
+               if (to != from) {
+                  edges.push_back({ from, to });
+               }
+            }
+         }
+      }
+      return edges;
+   }
+
+   /*
+    * takes up to wanted evaluations from the budget shared by the islands
+    * tickets is null if there is no evaluation limit
+    */
+   int claim(std::atomic<int>* tickets, int wanted) {
+      if (!tickets)
+         return wanted;
+      int available = tickets->load();
+      while (true) {
+         int granted = std::min(available, wanted);
+         if (granted <= 0)
+            return 0;
+         if (tickets->compare_exchange_weak(available, available - granted))
+            return granted;
+      }
+   }
+
+   bool fitter(const individual& a, const individual& b) {
+      return a.fitness < b.fitness;
+   }
+
+   // sends copies of the best members to the neighbours and takes in their migrants
+   void migrate(island& isl, int migrants) {
+      std::vector<individual> elites = isl.population;
+      std::size_t count = std::min<std::size_t>(migrants, elites.size());
+      std::partial_sort(elites.begin(), elites.begin() + count, elites.end(), fitter);
+      for (auto& send : isl.outgoing) {
+         for (std::size_t i = 0; i < count; ++i) {
+            send(elites[i]);
+         }
+      }
+      individual immigrant;
+      for (auto& receive : isl.incoming) {
+         while (receive(immigrant)) {
+            replacement::replace_worst(isl.population, immigrant);
+            isl.fittest = std::min(isl.fittest, immigrant.fitness);
+         }
+      }
+   }
+
+   // the generational algorithm of one island
+   void evolve(island& isl, Scenario& scenario,
+               initialization_func initialize, selection_func select,
+               recombination_func recombine, mutation_func mutate,
+               replacement_func replace, const island_config& config,
+               const run_budget& budget, std::atomic<int>* tickets) {
+      // the evaluations are limited by the tickets shared by all islands
+      run_budget island_budget = budget;
+      island_budget.evaluations = 0;
+      RunController controller(*isl.evaluator, island_budget);
+      isl.fittest = std::numeric_limits<double>::max();
+      isl.initial_fittest = isl.fittest;
+      // a population can't be initialized in part, so an island only
+      // starts if the budget still covers all of it
+      int granted = claim(tickets, config.population_size);
+      if (granted < config.population_size) {
+         if (tickets)
+            *tickets += granted;
+         std::cout << "Island " << isl.index << " has no evaluations left for its population"
+                   << std::endl;
+         return;
+      }
+      {
+         BBO_TIME_PHASE(initialize);
+         isl.population = initialize(*isl.evaluator, scenario);
+      }
+      for (auto& indiv : isl.population) {
+         isl.fittest = std::min(isl.fittest, indiv.fitness);
+      }
+      isl.initial_fittest = isl.fittest;
+      if (isl.population.empty())
+         return;
+
+      for (int g = 0; !controller.exhausted(); ++g) {
+         std::vector<std::vector<individual>::iterator> parents;
+         {
+            BBO_TIME_PHASE(select);
+            parents = select(isl.population);
+         }
+         std::vector<individual> children;
+         {
+            BBO_TIME_PHASE(recombine);
+            children = recombine(parents, scenario);
+         }
+         {
+            BBO_TIME_PHASE(mutate);
+            for (auto& child : children) {
+               mutate(child, scenario);
+            }
+         }
+
+         // the last generation might only get some of the evaluations it needs
+         std::size_t granted = claim(tickets, children.size());
+         bool partial = granted < children.size();
+         if (partial) {
+            children.resize(granted);
+         }
+         for (auto& child : children) {
+            {
+               BBO_TIME_PHASE(remove_illegal);
+               functions::remove_illegal_coordinates(child, scenario);
+            }
+            BBO_TIME_PHASE(evaluate);
+            functions::evaluate_individual(*isl.evaluator, child);
+         }
+         if (partial) {
+            for (auto& child : children) {
+               isl.fittest = std::min(isl.fittest, child.fitness);
+            }
+            break;
+         }
+
+         {
+            BBO_TIME_PHASE(replace);
+            isl.population = replace(isl.population, children);
+         }
+         for (auto& indiv : isl.population) {
+            isl.fittest = std::min(isl.fittest, indiv.fitness);
+         }
+
+         if (config.migration_interval > 0 && (g + 1) % config.migration_interval == 0) {
+            migrate(isl, config.migrants);
+            std::cout << "Island " << isl.index << ", generation " << g + 1
+                      << " : " << isl.fittest << std::endl;
+         }
+         if (controller.next_generation(isl.fittest)) {
+            std::cout << "Island " << isl.index << " stagnated: "
+                      << controller.stop_reason() << std::endl;
+            break;
+         }
+      }
+   }
+
+   // the wire format of a migrant: fitness, turbine count, x and y of each turbine
+   std::vector<char> serialize(const individual& indiv) {
+      std::size_t turbines = indiv.layout.size();
+      std::vector<char> message(sizeof(double) + sizeof(std::size_t)
+                                + turbines * 2 * sizeof(double));
+      char* it = message.data();
+      std::memcpy(it, &indiv.fitness, sizeof(double));
+      it += sizeof(double);
+      std::memcpy(it, &turbines, sizeof(std::size_t));
+      it += sizeof(std::size_t);
+      for (auto& coord : indiv.layout) {
+         std::memcpy(it, &coord.x, sizeof(double));
+         std::memcpy(it + sizeof(double), &coord.y, sizeof(double));
+         it += 2 * sizeof(double);
+      }
+      return message;
+   }
+
+   bool deserialize(const char* message, std::size_t size, individual& indiv) {
+      std::size_t turbines;
+      if (size < sizeof(double) + sizeof(std::size_t))
+         return false;
+      std::memcpy(&indiv.fitness, message, sizeof(double));
+      std::memcpy(&turbines, message + sizeof(double), sizeof(std::size_t));
+      const char* it = message + sizeof(double) + sizeof(std::size_t);
+      if (size != sizeof(double) + sizeof(std::size_t) + turbines * 2 * sizeof(double))
+         return false;
+      indiv.layout.resize(turbines);
+      for (auto& coord : indiv.layout) {
+         std::memcpy(&coord.x, it, sizeof(double));
+         std::memcpy(&coord.y, it + sizeof(double), sizeof(double));
+         it += 2 * sizeof(double);
+      }
+      return true;
+   }
+}
+
+std::pair<double, double> island_model(
+                                  evaluator_factory make_evaluator,
+                                  Scenario& scenario,
+                                  initialization_func initialize,
+                                  selection_func select,
+                                  recombination_func recombine,
+                                  mutation_func mutate,
+                                  replacement_func replace,
+                                  const island_config& config,
+                                  const run_budget& budget) {
+   std::vector<island> islands(config.islands);
+   for (int i = 0; i < config.islands; ++i) {
+      islands[i].index = i;
+      islands[i].evaluator = make_evaluator();
+   }
+
+   // one single-producer single-consumer queue per migration route
+   std::vector<std::unique_ptr<SpscQueue<individual>>> queues;
+   for (auto& edge : migration_edges(config.links, config.islands)) {
+      // room for a few migrations, in case the receiver is slower
+      queues.emplace_back(new SpscQueue<individual>(4 * config.migrants));
+      SpscQueue<individual>* queue = queues.back().get();
+      islands[edge.first].outgoing.push_back(
+         [queue](const individual& indiv) { return queue->push(indiv); });
+      islands[edge.second].incoming.push_back(
+         [queue](individual& indiv) { return queue->pop(indiv); });
+   }
+
+   std::atomic<int> tickets(budget.evaluations);
+   std::atomic<int>* shared_tickets = budget.evaluations > 0 ? &tickets : nullptr;
+   std::vector<std::thread> threads;
+   for (auto& isl : islands) {
+      threads.emplace_back([&, shared_tickets]() {
+         evolve(isl, scenario, initialize, select, recombine, mutate,
+                replace, config, budget, shared_tickets);
+      });
+   }
+   for (auto& thread : threads) {
+      thread.join();
+   }
+
+   double fittest = std::numeric_limits<double>::max();
+   double initial_fittest = std::numeric_limits<double>::max();
+   for (auto& isl : islands) {
+      fittest = std::min(fittest, isl.fittest);
+      initial_fittest = std::min(initial_fittest, isl.initial_fittest);
+   }
+   std::cout << "evals: " << islands.front().evaluator->getNumberOfEvaluation() << std::endl;
+   BBO_REPORT_TOTAL();
+   return{ fittest, initial_fittest - fittest };
+}
+
+std::pair<double, double> island_model_processes(
+                                  evaluator_factory make_evaluator,
+                                  Scenario& scenario,
+                                  initialization_func initialize,
+                                  selection_func select,
+                                  recombination_func recombine,
+                                  mutation_func mutate,
+                                  replacement_func replace,
+                                  const island_config& config,
+                                  const run_budget& budget) {
+   // one datagram socket pair per migration route, [0] sends, [1] receives
+   auto edges = migration_edges(config.links, config.islands);
+   std::vector<std::pair<int, int>> sockets;
+   for (std::size_t e = 0; e < edges.size(); ++e) {
+      int fds[2];
+      if (socketpair(AF_UNIX, SOCK_DGRAM, 0, fds) != 0) {
+         std::cerr << "ERROR: could not create the migration sockets" << std::endl;
+         return{ 0.0, 0.0 };
+      }
+      sockets.push_back({ fds[0], fds[1] });
+   }
+
+   std::vector<pid_t> children;
+   // the pipes on which the islands report their results
+   std::vector<int> results;
+   for (int i = 0; i < config.islands; ++i) {
+      int result_pipe[2];
+      if (pipe(result_pipe) != 0) {
+         std::cerr << "ERROR: could not create the result pipe" << std::endl;
+         break;
+      }
+      std::cout << std::flush;
+      pid_t pid = fork();
+      if (pid < 0) {
+         std::cerr << "ERROR: could not start island " << i << std::endl;
+         close(result_pipe[0]);
+         close(result_pipe[1]);
+         break;
+      }
+      if (pid == 0) {
+         // the island process, rand() would repeat the parent's sequence otherwise
+         srand(time(NULL) ^ (getpid() << 16));
+         // keep only the ends of this island, a sibling's end left open here
+         // would keep its socket alive after the sibling exits
+         close(result_pipe[0]);
+         for (int fd : results) {
+            close(fd);
+         }
+         for (std::size_t e = 0; e < edges.size(); ++e) {
+            if (edges[e].first != i)
+               close(sockets[e].first);
+            if (edges[e].second != i)
+               close(sockets[e].second);
+         }
+         island isl;
+         isl.index = i;
+         isl.evaluator = make_evaluator();
+         // the migrants are received one at a time, so they share a buffer
+         std::vector<char> receive_buffer(MAX_MESSAGE_SIZE);
+         for (std::size_t e = 0; e < edges.size(); ++e) {
+            int send_fd = sockets[e].first;
+            int receive_fd = sockets[e].second;
+            if (edges[e].first == i) {
+               isl.outgoing.push_back([send_fd](const individual& indiv) {
+                  std::vector<char> message = serialize(indiv);
+                  return send(send_fd, message.data(), message.size(), MSG_DONTWAIT) >= 0;
+               });
+            }
+            if (edges[e].second == i) {
+               isl.incoming.push_back([receive_fd, &receive_buffer](individual& indiv) {
+                  ssize_t size = recv(receive_fd, receive_buffer.data(), receive_buffer.size(),
+                                      MSG_DONTWAIT);
+                  return size > 0 && deserialize(receive_buffer.data(), size, indiv);
+               });
+            }
+         }
+         // the islands can't share the budget, so each one gets its part
+         int share = budget.evaluations / config.islands
+            + (i < budget.evaluations % config.islands ? 1 : 0);
+         std::atomic<int> tickets(share);
+         evolve(isl, scenario, initialize, select, recombine, mutate, replace,
+                config, budget, budget.evaluations > 0 ? &tickets : nullptr);
+         double report[2] = { isl.initial_fittest, isl.fittest };
+         ssize_t written = write(result_pipe[1], report, sizeof(report));
+         std::cout << std::flush;
+         _exit(written == sizeof(report) ? 0 : 1);
+      }
+      close(result_pipe[1]);
+      children.push_back(pid);
+      results.push_back(result_pipe[0]);
+   }
+   // every island has its own copies of the socket ends it uses
+   for (auto& socket : sockets) {
+      close(socket.first);
+      close(socket.second);
+   }
+
+   double fittest = std::numeric_limits<double>::max();
+   double initial_fittest = std::numeric_limits<double>::max();
+   for (std::size_t i = 0; i < children.size(); ++i) {
+      double report[2];
+      if (read(results[i], report, sizeof(report)) == sizeof(report)) {
+         initial_fittest = std::min(initial_fittest, report[0]);
+         fittest = std::min(fittest, report[1]);
+      } else {
+         std::cerr << "ERROR: island " << i << " didn't report a result" << std::endl;
+      }
+      close(results[i]);
+      waitpid(children[i], nullptr, 0);
+   }
+   if (fittest == std::numeric_limits<double>::max())
+      return{ 0.0, 0.0 };
+   return{ fittest, initial_fittest - fittest };
+}
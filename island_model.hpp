@@ -0,0 +1,93 @@
+/*
+ * island_model.hpp
+ *
+ * contains the island model, which runs several populations in parallel
+ * and lets them exchange their best members
+ */
+#ifndef BBO_ISLAND_MODEL_HPP
+#define BBO_ISLAND_MODEL_HPP
+
+#include "evolutionary_algorithm.hpp"
+#include "run_controller.hpp"
+
+// which islands send migrants to which
+enum class topology {
+   ring,           // island i sends to island i + 1, the last one to the first
+   fully_connected // every island sends to every other island
+};
+
+/* struct island_config
+ *
+ * the parameters of the island model
+ */
+struct island_config {
+   // the number of islands, each one evolves its own population
+   int islands;
+   // the number of generations between two migrations
+   int migration_interval;
+   // the number of best members each island sends to each neighbour
+   int migrants;
+   // the migration topology
+   topology links;
+   // the number of members initialize creates, which are claimed from the
+   // evaluation budget before an island initializes
+   int population_size;
+};
+
+/*
+ * island_model
+ *
+ * runs one island per thread. each island is a generational algorithm with
+ * its own population and evaluator, built from the given functions
+ * (initialize is called once per island, so it determines the population
+ * size of an island). every migration_interval generations an island sends
+ * copies of its best members over lock-free queues to its neighbours and
+ * inserts the migrants it received with replacement::replace_worst
+ *
+ * the evaluation and time budget is shared by all islands, the generation
+ * and stagnation limits apply to each island on its own
+ *
+ * parameters:
+ * make_evaluator - creates the evaluator of each island
+ * scenario - the wind scenario to solve
+ * initialize, select, recombine, mutate, replace - the operators
+ * config - the island parameters
+ * budget - the limits of the run
+ *
+ * returns:
+ * fittest, improvement - the best fitness of all islands and the improvement
+ *                        from the initial best fitness to the final one
+ */
+std::pair<double, double> island_model(
+                                  evaluator_factory make_evaluator,
+                                  Scenario& scenario,
+                                  initialization_func initialize,
+                                  selection_func select,
+                                  recombination_func recombine,
+                                  mutation_func mutate,
+                                  replacement_func replace,
+                                  const island_config& config,
+                                  const run_budget& budget);
+
+/*
+ * island_model_processes
+ *
+ * the same as island_model, but every island runs in its own process
+ * (created with fork) and the migrants are sent as datagrams over local
+ * unix sockets. the islands don't share memory, so the evaluation budget
+ * is split evenly between them
+ *
+ * must be called before any other threads are started
+ */
+std::pair<double, double> island_model_processes(
+                                  evaluator_factory make_evaluator,
+                                  Scenario& scenario,
+                                  initialization_func initialize,
+                                  selection_func select,
+                                  recombination_func recombine,
+                                  mutation_func mutate,
+                                  replacement_func replace,
+                                  const island_config& config,
+                                  const run_budget& budget);
+
+#endif
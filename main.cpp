@@ -5,7 +5,10 @@
  */
 
 //STL libraries
+#include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <random>
 #include <iostream>
 #include <string>
 
@@ -24,7 +27,17 @@
 #include "replacement.hpp"
 #include "evolutionary_algorithm.hpp"
 #include "statistical_comparison.hpp"
+#include "steady_state.hpp"
+#include "island_model.hpp"
+#include "surrogate.hpp"
+#include "fidelity.hpp"
+#include "parallel_initialization.hpp"
+#include "thread_pool.hpp"
+#include "wake_field.hpp"
+#include "hilbert.hpp"
+#include "functions.hpp"
 #include "scenario.hpp"
+#include "instrumentation.hpp"
 #include <time.h>
 #include <stdlib.h>
 #include <fstream>
@@ -50,6 +63,10 @@ int main(int argc, const char * argv[]) {
        
        statistical_comparison(pop_size, generations, iterations, argv[2]);
    } else {
+       // an optional second argument is the file the trace is written to
+       if (argc > 2) {
+          instrumentation::enable_trace(argv[2]);
+       }
        bool serious_mode = false;
        std::cout << "Run against the server? (0/1)" << std::endl;
        std::cin >> serious_mode;
@@ -57,7 +74,11 @@ int main(int argc, const char * argv[]) {
        std::unique_ptr<WindFarmLayoutEvaluator> evaluator;
        std::unique_ptr<CompetitionScenario> cscenario;
        std::unique_ptr<WindScenario> wscenario;
+       // the constants of the local scenario, shared by all its evaluators
+       std::shared_ptr<const CompiledScenario> compiled;
        std::unique_ptr<Scenario> scenario;
+       // creates additional evaluators for the worker threads
+       evaluator_factory make_evaluator;
        if (serious_mode) {
           int sc_number;
           std::cout << "Scenario number? (1 to 5)" << std::endl;
@@ -69,12 +90,24 @@ int main(int argc, const char * argv[]) {
           CompetitionEvaluator* cevaluator = new CompetitionEvaluator();
           cevaluator->initialize(*cscenario, TOKEN);
           evaluator.reset(cevaluator);
+          make_evaluator = [&cscenario, TOKEN]() {
+             CompetitionEvaluator* worker_evaluator = new CompetitionEvaluator();
+             worker_evaluator->initialize(*cscenario, TOKEN);
+             return std::unique_ptr<WindFarmLayoutEvaluator>(worker_evaluator);
+          };
        } else {
-          wscenario.reset(new WindScenario(argv[1]));
+          compiled = CompiledScenario::load(argv[1]);
+          // the adapter needs a scenario of its own
+          wscenario.reset(new WindScenario(compiled->scenario));
           scenario.reset(new Scenario(*wscenario));
           KusiakLayoutEvaluator* kevaluator = new KusiakLayoutEvaluator();
-          kevaluator->initialize(*wscenario);
+          kevaluator->initialize(compiled);
           evaluator.reset(kevaluator);
+          make_evaluator = [compiled]() {
+             KusiakLayoutEvaluator* worker_evaluator = new KusiakLayoutEvaluator();
+             worker_evaluator->initialize(compiled);
+             return std::unique_ptr<WindFarmLayoutEvaluator>(worker_evaluator);
+          };
        }
        
        int pop_size = 0;
@@ -100,18 +133,202 @@ int main(int argc, const char * argv[]) {
        }
        std::cout << "Enter the number of generations: " << std::endl;
        std::cin >> generations;
-       double fitness = evolutionary_algorithm(
-          *evaluator,
-          *scenario,
-          std::bind(initialization::initialization_2, _1,_2,pop_size),
-          std::bind(selection::selection_1, _1, pop_size),
-          recombination::crossover,
-          std::bind(mutation::random_reset, 0.25f, _1, _2),
-          std::bind(replacement::replacement_1,_1,_2, pop_size),
-          generations,
-          shouldLoadFile,
-          shouldSaveFile
-          ).first;
+       int evaluations = 0;
+       int stagnation = 0;
+       std::cout << "Enter the evaluation budget (0 for no limit): " << std::endl;
+       std::cin >> evaluations;
+       std::cout << "Enter the number of generations without improvement "
+                 << "before a restart (0 for never): " << std::endl;
+       std::cin >> stagnation;
+       int algorithm = 0;
+       int workers = 0;
+       std::cout << "Which algorithm? (0 generational, 1 steady-state, "
+                 << "2 islands on threads, 3 islands in processes)" << std::endl;
+       std::cin >> algorithm;
+       if (algorithm > 0) {
+          std::cout << "Enter the number of worker threads or islands: " << std::endl;
+          std::cin >> workers;
+       }
+       // the wind exposure, only built for the operators which sample from it
+       std::unique_ptr<WakeField> field;
+       auto wake_field = [&]() -> const WakeField& {
+          if (!field)
+             field.reset(compiled ? new WakeField(compiled) : new WakeField(*cscenario));
+          return *field;
+       };
+       int init = 0;
+       std::cout << "Which initialization? (0 random, 1 poisson disk, "
+                 << "2 random in parallel, 3 poisson disk in parallel, "
+                 << "4 wake sampled, 5 wake sampled in parallel)" << std::endl;
+       std::cin >> init;
+       bool poisson = init == 1 || init == 3;
+       bool sampled = init >= 4;
+       initialization_func initialize = poisson ?
+          std::bind(initialization::initialization_3, _1, _2, pop_size) :
+          std::bind(initialization::initialization_2, _1, _2, pop_size);
+       if (sampled) {
+          initialize = std::bind(initialization::initialization_4,
+                                 std::cref(wake_field()), _1, _2, pop_size);
+       }
+       // the islands already initialize side by side, and a pool wouldn't
+       // survive the fork of the island processes
+       std::unique_ptr<ParallelInitializer> parallel_init;
+       if ((init == 2 || init == 3 || init == 5) && algorithm < 2) {
+          std::random_device device;
+          std::uint32_t seed = device();
+          std::cout << "Initialization seed: " << seed << std::endl;
+          initialization::layout_func layout = initialization::random_layout;
+          if (poisson) {
+             layout = initialization::sized_poisson_disk_layout;
+          } else if (sampled) {
+             layout = std::bind(initialization::sampled_layout,
+                                std::cref(wake_field()), _1, _2);
+          }
+          parallel_init.reset(new ParallelInitializer(
+             make_evaluator, workers, pop_size, layout, seed));
+          initialize = std::ref(*parallel_init);
+       }
+       int mutation_choice = 0;
+       std::cout << "Which mutation? (0 random reset, 1 wake guided, "
+                 << "2 wake sampled random reset)" << std::endl;
+       std::cin >> mutation_choice;
+       mutation_func mutate = std::bind(mutation::random_reset, 0.25f, _1, _2);
+       if (mutation_choice == 1) {
+          // the worst quarter of the turbines, best of 8 positions each,
+          // ranked by the ratios of their last evaluation
+          functions::keep_wake_free_ratios(true);
+          mutate = std::bind(mutation::guided, std::cref(wake_field()), 0.25f, 8, _1, _2);
+       } else if (mutation_choice == 2) {
+          mutate = std::bind(mutation::random_reset_sampled, std::cref(wake_field()),
+                             0.25f, _1, _2);
+       }
+       int recombination_choice = 0;
+       std::cout << "Which recombination? (0 crossover, 1 wake sampled crossover)"
+                 << std::endl;
+       std::cin >> recombination_choice;
+       recombination_func recombine = recombination::crossover;
+       if (recombination_choice) {
+          recombine = std::bind(recombination::crossover_sampled,
+                                std::cref(wake_field()), _1, _2);
+       }
+       int hilbert_order = 0;
+       std::cout << "Keep the layouts in Hilbert order? (0/1)" << std::endl;
+       std::cin >> hilbert_order;
+       if (hilbert_order) {
+          initialize = hilbert::ordered(initialize);
+          recombine = hilbert::ordered(recombine);
+          mutate = hilbert::ordered(mutate);
+       }
+       run_budget budget = { generations, evaluations, 0.0, stagnation, 0.0, true };
+       // each island has a population of pop_size, migrates its 2 best
+       // members every 5 generations to the next island of the ring
+       island_config islands = { workers, 5, 2, topology::ring, pop_size };
+       double fitness;
+       if (algorithm == 1) {
+          // the steady-state algorithm neither loads nor saves populations
+          fitness = steady_state_algorithm(
+             *evaluator,
+             make_evaluator,
+             workers,
+             *scenario,
+             initialize,
+             std::bind(selection::selection_1, _1, pop_size),
+             recombine,
+             mutate,
+             replacement::replace_worst,
+             budget
+             ).first;
+       } else if (algorithm == 2 || algorithm == 3) {
+          auto run_islands = algorithm == 2 ? island_model : island_model_processes;
+          fitness = run_islands(
+             make_evaluator,
+             *scenario,
+             initialize,
+             std::bind(selection::selection_1, _1, pop_size),
+             recombine,
+             mutate,
+             std::bind(replacement::replacement_1,_1,_2, pop_size),
+             islands,
+             budget
+             ).first;
+       } else {
+          // the surrogate and the low-fidelity evaluator need the wind
+          // resource, which only a local scenario has
+          int screening = 0;
+          if (!serious_mode) {
+             std::cout << "How are the children evaluated? (0 exactly, "
+                       << "1 surrogate pre-screening, 2 multi-fidelity, "
+                       << "3 single precision screening)" << std::endl;
+             std::cin >> screening;
+          }
+          // one layout is evaluated at a time, so a huge one is split
+          // across a pool; the calling thread helps, hence threads - 1
+          int evaluation_threads = 1;
+          std::unique_ptr<ThreadPool> evaluation_pool;
+          if (!serious_mode) {
+             std::cout << "Enter the number of threads per evaluation (1 for serial): "
+                       << std::endl;
+             std::cin >> evaluation_threads;
+          }
+          if (evaluation_threads > 1) {
+             evaluation_pool.reset(new ThreadPool(evaluation_threads - 1));
+             ThreadPool& pool = *evaluation_pool;
+             static_cast<KusiakLayoutEvaluator&>(*evaluator).setParallelFor(
+                [&pool](int count, const std::function<void(int)>& body) {
+                   pool.parallel_for(count, body);
+                });
+          }
+          // 8 nearest neighbours, 95% of the wind energy, a quarter of the
+          // children evaluated exactly, fall back above 5% error
+          surrogate_config surrogate_cfg = { 8, 0.95, 0.25, 2 * pop_size, 0.05, 5 };
+          // 90% of the wind energy in low fidelity for the whole run,
+          // the best quarter of the children is promoted
+          fidelity_config fidelity_cfg = { 0.9, false, 0, promotion::top_k,
+                                           std::max(1, pop_size / 4), 0.0 };
+          if (screening == 3) {
+             // all directions in single precision, the best quarter is
+             // evaluated again in double
+             fidelity_cfg.direction_share = 1.0;
+             fidelity_cfg.single_precision = true;
+          }
+          std::unique_ptr<Surrogate> surrogate;
+          std::unique_ptr<FidelityScheduler> scheduler;
+          evaluation_func evaluate =
+             [](WindFarmLayoutEvaluator& evaluator, std::vector<individual>& children, int) {
+                for (auto& child : children) {
+                   functions::evaluate_individual(evaluator, child);
+                }
+             };
+          if (screening == 1) {
+             surrogate.reset(new Surrogate(compiled, surrogate_cfg));
+             evaluate = std::bind(&Surrogate::evaluate, surrogate.get(), _1, _2, _3);
+          } else if (screening == 2 || screening == 3) {
+             scheduler.reset(new FidelityScheduler(compiled, fidelity_cfg));
+             evaluate = std::bind(&FidelityScheduler::evaluate, scheduler.get(), _1, _2, _3);
+          }
+          fitness = evolutionary_algorithm(
+             *evaluator,
+             *scenario,
+             initialize,
+             std::bind(selection::selection_1, _1, pop_size),
+             recombine,
+             mutate,
+             std::bind(replacement::replacement_1,_1,_2, pop_size),
+             evaluate,
+             budget,
+             shouldLoadFile,
+             shouldSaveFile
+             ).first;
+          if (surrogate) {
+             std::cout << "Surrogate: " << surrogate->rejected() << " children rejected, "
+                       << "error " << surrogate->error() << std::endl;
+          }
+          if (scheduler) {
+             std::cout << "Fidelity: " << scheduler->low_evaluations() << " low, "
+                       << scheduler->exact_evaluations() << " exact, max relative error "
+                       << scheduler->max_error() << std::endl;
+          }
+       }
        std::cout << "Best " << fitness << std::endl;
    }
 }
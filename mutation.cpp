@@ -3,9 +3,39 @@
 
 #include "mutation.hpp"
 #include "functions.hpp"
+#include "instrumentation.hpp"
+#include "spatial_index.hpp"
 
 namespace mutation {
+   namespace {
+      // the creep positions drawn per turbine before creep falls back, and
+      // the positions drawn by the sampled operators per turbine
+      const int CREEP_ATTEMPTS = 64;
+
+      // every thread draws from its own engine, seeded once
+      std::mt19937& engine() {
+         thread_local std::mt19937 engine(std::random_device{}());
+         return engine;
+      }
+
+      // the spatial index of this thread, emptied and fitted to the scenario
+      SpatialIndex& workspace(Scenario& scenario) {
+         return thread_index(scenario.width, scenario.height, 8.0 * scenario.R);
+      }
+
+      // the same test as functions::turbine_collides, against the index
+      bool collides(double x, double y, Scenario& scenario, const SpatialIndex& index) {
+         BBO_COUNT(collision_checks, 1);
+         return functions::coordinateCollidesWithObstacles(x, y, scenario) ||
+                index.collides(x, y);
+      }
+   }
+
    void creep(double range, individual& indiv, Scenario& scenario) {
+      creep_bounded(range, CREEP_ATTEMPTS, indiv, scenario);
+   }
+
+   void creep_bounded(double range, int max_attempts, individual& indiv, Scenario& scenario) {
       // This is the min distance among turbines that must be satisfied
       double min_distance = 16.0 * scenario.R;
       // the scenario dimensions
@@ -19,19 +49,25 @@ namespace mutation {
          range = std::max(range, min_distance);
       }
       
-      // prepare the rng
-      std::random_device device;
-      std::default_random_engine engine(device());
-      // prepare a distribution
+      // prepare the distributions
       std::uniform_real_distribution<double> dist(-range, range);
+      std::uniform_real_distribution<double> wdist(0.0, width);
+      std::uniform_real_distribution<double> hdist(0.0, height);
 
-      std::vector<coordinate> new_layout;
-      // apply the randomization to each coordinate pair in the layout
+      // the coordinates which were already moved
+      SpatialIndex& moved = workspace(scenario);
+      // apply the randomization to each coordinate pair in the layout, in place
+      // turbines without a place are dropped, the kept ones are moved to the front
+      std::size_t kept = 0;
       for (auto& coords : indiv.layout) {
          double x = coords.x;
          double y = coords.y;
-         do {
-            x += dist(engine);
+         // the number of positions drawn for this turbine
+         int attempts = 0;
+         bool placed = false;
+         while (!placed && attempts < max_attempts) {
+            ++attempts;
+            x += dist(engine());
             // enforce the layout width
             // if violated, the coordinate will wrap around the x-axis
             if (x < 0.0) {
@@ -40,7 +76,7 @@ namespace mutation {
                x -= width;
             }
          
-            y += dist(engine);
+            y += dist(engine());
             // enforce the layout height
             // if violated, the coordinate will wrap around the y-axis
             if (y < 0.0) {
@@ -48,43 +84,159 @@ namespace mutation {
             } else if (y > height) {
                y -= height;
             }
-         } while (functions::turbine_collides(x, y, scenario, new_layout));
-         new_layout.push_back({ x, y });
+            placed = !collides(x, y, scenario, moved);
+         }
+         // fall back to the old position, then to anywhere in the free space
+         if (!placed) {
+            x = coords.x;
+            y = coords.y;
+            placed = !collides(x, y, scenario, moved);
+         }
+         for (int a = 0; !placed && a < max_attempts; ++a) {
+            ++attempts;
+            x = wdist(engine());
+            y = hdist(engine());
+            placed = !collides(x, y, scenario, moved);
+         }
+         BBO_RETRIES(attempts - (placed ? 1 : 0));
+         if (!placed) {
+            BBO_COUNT(dropped_turbines, 1);
+            continue;
+         }
+         indiv.layout[kept] = { x, y, 0.0 };
+         moved.insert(indiv.layout[kept]);
+         ++kept;
       }
-      indiv.layout = new_layout;
+      indiv.layout.resize(kept);
    }
 
    void random_reset(float chance, individual& indiv, Scenario& scenario) {      
-      // This is the min distance among turbines that must be satisfied
-      double min_distance = 8.0 * scenario.R;
       // the scenario dimensions
       double width = scenario.width;
       double height = scenario.height;
          
-      // prepare the rng
-      std::random_device device;
-      std::default_random_engine engine(device());
       // prepare the distributions
-      std::uniform_real_distribution<float> cdist(0.f, 1.f);
       std::uniform_real_distribution<double> wdist(0.0, width);
       std::uniform_real_distribution<double> hdist(0.0, height); 
       // determine how many coordinates should be reset
       std::size_t size = indiv.layout.size();
       std::size_t rsize = size * chance;
 
-      // copy the not to be reset coordinates
-      std::vector<coordinate> new_layout;
-      std::copy(indiv.layout.begin(), indiv.layout.begin() + rsize, 
-         std::back_inserter(new_layout));
-      // add the reseted coordinates
+      // the not to be reset coordinates are kept
+      SpatialIndex& placed = workspace(scenario);
+      for (std::size_t i = 0; i < rsize; ++i) {
+         placed.insert(indiv.layout[i]);
+      }
+      // reset the others in place
       for (std::size_t i = rsize; i < size; ++i) {
          double x;
          double y;
+         // the number of positions drawn for this turbine
+         std::size_t attempts = 0;
          do {
-            x = wdist(engine);
-            y = hdist(engine);
-         } while (functions::turbine_collides(x, y, scenario, new_layout));
-         new_layout.push_back({ x, y });
+            ++attempts;
+            x = wdist(engine());
+            y = hdist(engine());
+         } while (collides(x, y, scenario, placed));
+         BBO_RETRIES(attempts - 1);
+         indiv.layout[i] = { x, y, 0.0 };
+         placed.insert(indiv.layout[i]);
+      }
+   }
+
+   void random_reset_sampled(const WakeField& field, float chance, individual& indiv,
+                             Scenario& scenario) {
+      // determine how many coordinates should be reset
+      std::size_t size = indiv.layout.size();
+      std::size_t rsize = size * chance;
+
+      // the not to be reset coordinates are kept
+      SpatialIndex& placed = workspace(scenario);
+      WakeShadow shadow(field);
+      for (std::size_t i = 0; i < rsize; ++i) {
+         placed.insert(indiv.layout[i]);
+         shadow.add(indiv.layout[i]);
+      }
+      // reset the others in place, the placed ones are moved to the front
+      std::size_t kept = rsize;
+      for (std::size_t i = rsize; i < size; ++i) {
+         double x;
+         double y;
+         // the number of positions drawn for this turbine
+         int attempts = 0;
+         bool valid = false;
+         while (!valid && attempts < CREEP_ATTEMPTS) {
+            ++attempts;
+            shadow.draw(engine(), x, y);
+            valid = !collides(x, y, scenario, placed);
+         }
+         BBO_RETRIES(attempts - (valid ? 1 : 0));
+         if (!valid) {
+            BBO_COUNT(dropped_turbines, 1);
+            continue;
+         }
+         indiv.layout[kept] = { x, y, 0.0 };
+         placed.insert(indiv.layout[kept]);
+         shadow.add(indiv.layout[kept]);
+         ++kept;
+      }
+      indiv.layout.resize(kept);
+   }
+
+   void guided(const WakeField& field, float share, int candidates,
+               individual& indiv, Scenario& scenario) {
+      std::size_t size = indiv.layout.size();
+      std::size_t rsize = size * share;
+      if (rsize == 0)
+         return;
+
+      // the worst turbines come first
+      auto ratio = [](const coordinate& c) {
+         return c.wake_free_ratio > 0.0 ? c.wake_free_ratio : 1.0;
+      };
+      std::vector<coordinate> layout = indiv.layout;
+      std::partial_sort(layout.begin(), layout.begin() + rsize, layout.end(),
+                        [&](const coordinate& a, const coordinate& b) {
+                           return ratio(a) < ratio(b);
+                        });
+      // keep the others
+      std::vector<coordinate> new_layout(layout.begin() + rsize, layout.end());
+      SpatialIndex& placed = workspace(scenario);
+      for (auto& coord : new_layout) {
+         placed.insert(coord);
+      }
+      WakeShadow shadow(field);
+      shadow.reset(new_layout);
+      for (std::size_t i = 0; i < rsize; ++i) {
+         coordinate best = { 0.0, 0.0, 0.0 };
+         double best_yield = -1.0;
+         for (int c = 0; c < std::max(1, candidates); ++c) {
+            double x;
+            double y;
+            // the number of positions drawn for this candidate
+            int attempts = 0;
+            bool valid = false;
+            while (!valid && attempts < CREEP_ATTEMPTS) {
+               ++attempts;
+               shadow.draw(engine(), x, y);
+               valid = !collides(x, y, scenario, placed);
+            }
+            BBO_RETRIES(attempts - (valid ? 1 : 0));
+            if (!valid)
+               continue;
+            double yield = shadow.yield(x, y);
+            if (yield > best_yield) {
+               best = { x, y, 0.0 };
+               best_yield = yield;
+            }
+         }
+         if (best_yield < 0.0) {
+            BBO_COUNT(dropped_turbines, 1);
+            continue;
+         }
+         new_layout.push_back(best);
+         placed.insert(best);
+         shadow.add(best);
       }
       indiv.layout = new_layout;
    }
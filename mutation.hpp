@@ -8,14 +8,19 @@
 
 #include "scenario.hpp"
 #include "structures.hpp"
+#include "wake_field.hpp"
 
 namespace mutation{
    /*
     * mutation::creep
     *
     * applies creep (incremental mutation) to one individual
-    * creep steps are sampled from a cauchy distribution
+    * creep steps are sampled from a uniform distribution
     * the function tests for layout boundaries and re-enforces them
+    * the layout is changed in place, collisions are checked with a spatial
+    * index and random numbers drawn from an engine which both belong to the
+    * thread, so no memory is allocated once they are warm
+    * at most 64 steps are tried per turbine, see creep_bounded
     *
     * parameters:
     * range - the distribution will be (-range, range)
@@ -23,13 +28,30 @@ namespace mutation{
     * kle - the evaluator
     */
    void creep(double range, individual& indiv, Scenario& scenario);
-   
+
+   /*
+    * mutation::creep_bounded
+    *
+    * creep with at most max_attempts steps per turbine. if none of them is
+    * valid, the turbine keeps its old position if that is still valid, else
+    * up to max_attempts uniform positions are drawn, else it is dropped. so
+    * a turbine costs at most 2 * max_attempts + 1 collision checks
+    *
+    * parameters:
+    * range - the distribution will be (-range, range)
+    * max_attempts - the steps, and uniform positions, tried per turbine
+    * individual - the individual to mutate
+    * scenario - the scenario
+    */
+   void creep_bounded(double range, int max_attempts, individual& indiv, Scenario& scenario);
+
    /*
     * mutation::random_reset
     *
     * applies a mutation which simply resets a random number of coordinates
     * each x and y coordinate has a chance to be reset independently
     * reset coordinates are drawn uniformly from 0 to the layout boundaries
+    * like creep, it works in place without allocating
     *
     * parameters:
     * chance - probability that a coordinate is reset
@@ -37,6 +59,43 @@ namespace mutation{
     * kle - the evaluator
     */
    void random_reset(float chance, individual& indiv, Scenario& scenario);
+
+   /*
+    * mutation::random_reset_sampled
+    *
+    * random_reset, but the reset turbines are drawn in proportion to the
+    * yield left over by the kept ones and the ones reset before them (see
+    * WakeShadow) instead of uniformly. at most 64 positions are drawn per
+    * turbine, a turbine without a valid one is dropped
+    *
+    * parameters:
+    * field - the wind exposure of the scenario
+    * chance - probability that a coordinate is reset
+    * individual - the individual to mutate
+    * scenario - the scenario
+    */
+   void random_reset_sampled(const WakeField& field, float chance, individual& indiv,
+                             Scenario& scenario);
+
+   /*
+    * mutation::guided
+    *
+    * relocates the turbines with the lowest wake free ratio of the last
+    * evaluation instead of random ones (turbines which weren't evaluated yet
+    * count as unshadowed). for each of them a few valid positions are drawn
+    * in proportion to the yield left over by the kept turbines (see
+    * WakeShadow), and the one in the best cell is taken. a candidate gets
+    * at most 64 draws, a turbine without any valid candidate is dropped
+    *
+    * parameters:
+    * field - the wind exposure of the scenario
+    * share - the share of the turbines which is relocated
+    * candidates - the number of positions drawn per relocated turbine
+    * individual - the individual to mutate
+    * scenario - the scenario
+    */
+   void guided(const WakeField& field, float share, int candidates,
+               individual& indiv, Scenario& scenario);
 }
 
 #endif
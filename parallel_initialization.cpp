@@ -0,0 +1,29 @@
+#include "parallel_initialization.hpp"
+
+#include <random>
+
+ParallelInitializer::ParallelInitializer(evaluator_factory make_evaluator, int threads,
+                                         int pop_size, initialization::layout_func layout,
+                                         std::uint32_t seed)
+   : pool(threads), pop_size(pop_size), layout(layout), seed(seed), calls(0) {
+   for (int w = 0; w < pool.size(); ++w) {
+      evaluators.push_back(make_evaluator());
+   }
+}
+
+std::vector<individual> ParallelInitializer::operator()(WindFarmLayoutEvaluator&,
+                                                        Scenario& scenario) {
+   std::vector<individual> population(pop_size);
+   std::uint32_t call = calls++;
+   for (int i = 0; i < pop_size; ++i) {
+      pool.submit([this, &population, &scenario, call, i](int worker) {
+         std::seed_seq substream = { seed, call, static_cast<std::uint32_t>(i) };
+         std::mt19937 engine(substream);
+         // each task only writes its own individual
+         population[i].layout = layout(scenario, engine);
+         functions::evaluate_individual(*evaluators[worker], population[i]);
+      });
+   }
+   pool.wait();
+   return population;
+}
@@ -0,0 +1,68 @@
+/*
+ * parallel_initialization.hpp
+ *
+ * contains an initialization which creates and evaluates the individuals
+ * of a population on a thread pool
+ */
+#ifndef BBO_PARALLEL_INITIALIZATION_HPP
+#define BBO_PARALLEL_INITIALIZATION_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "API/WindFarmLayoutEvaluator.h"
+#include "evolutionary_algorithm.hpp"
+#include "initialization.hpp"
+#include "scenario.hpp"
+#include "structures.hpp"
+#include "thread_pool.hpp"
+
+/*
+ * ParallelInitializer
+ *
+ * an initialization_func (use it through std::ref) which creates each
+ * individual in its own task: the layout is drawn and evaluated by the same
+ * worker, with the evaluator of that worker
+ *
+ * every individual draws from its own engine, seeded with (seed, call,
+ * index), so a population only depends on the seed and on how often the
+ * initializer was called before, not on the number of threads or on the
+ * order the tasks run in
+ *
+ * the evaluators are created in the constructor, because initializing an
+ * evaluator resets the evaluation counter, so construct it before the run
+ */
+class ParallelInitializer {
+public:
+   /*
+    * parameters:
+    *    make_evaluator - creates the evaluator of a worker
+    *    threads - the number of workers, 0 for one per hardware thread
+    *    pop_size - the number of individuals to create
+    *    layout - draws the layout of an individual, e.g.
+    *             initialization::random_layout
+    *    seed - the seed of all engines
+    */
+   ParallelInitializer(evaluator_factory make_evaluator, int threads, int pop_size,
+                       initialization::layout_func layout, std::uint32_t seed);
+
+   /*
+    * ParallelInitializer::operator()
+    *
+    * creates and evaluates a population. the given evaluator isn't used,
+    * each worker evaluates with its own
+    */
+   std::vector<individual> operator()(WindFarmLayoutEvaluator& evaluator, Scenario& scenario);
+
+private:
+   ThreadPool pool;
+   std::vector<std::unique_ptr<WindFarmLayoutEvaluator>> evaluators;
+   int pop_size;
+   initialization::layout_func layout;
+   std::uint32_t seed;
+   // the number of populations created so far, e.g. by restarts
+   std::uint32_t calls;
+};
+
+#endif
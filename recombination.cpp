@@ -1,8 +1,12 @@
 #include <algorithm>
+#include <cmath>
+#include <memory>
 #include <random>
 
 #include "functions.hpp"
+#include "instrumentation.hpp"
 #include "recombination.hpp"
+#include "spatial_index.hpp"
 
 namespace recombination {
    std::vector<individual> none(const std::vector<std::vector<individual>::iterator>& parents,
@@ -15,74 +19,122 @@ namespace recombination {
       return children;
    }
    
-   std::vector<individual> crossover(const std::vector<std::vector<individual>::iterator>& parents,
-                                     Scenario& scenario) {      
-      // the return value
-      std::vector<individual> children;
-
-      // the rng
-      std::random_device device;
-      std::mt19937 rng(device());
+   namespace {
+      // the crossover, field is null for uniform new turbines
+      std::vector<individual> cut_and_fill(
+         const WakeField* field,
+         const std::vector<std::vector<individual>::iterator>& parents,
+         Scenario& scenario) {
+         // the return value
+         std::vector<individual> children;
 
-      // combine each parent with the one next to it
-      for (auto it = parents.begin(); it != parents.end(); ++it) {
-         auto& layout_a = (*(it))->layout;
-         auto& layout_b = it + 1 == parents.end() ?
-	    (*(parents.begin()))->layout : (*(it + 1))->layout;
+         // the rng
+         std::random_device device;
+         std::mt19937 rng(device());
+         std::uniform_real_distribution<double> wdist(0.0, scenario.width);
+         std::uniform_real_distribution<double> hdist(0.0, scenario.height); 
+         std::uniform_real_distribution<double> adist(0.0, 2.0 * M_PI);
 
-         // sort the layouts so that the crossover is geometric
-         auto coord_compare = [](const coordinate& a, const coordinate& b) {
-            return a.y == b.y ? a.x < b.x : a.y < b.y;
+         // the turbines of the child, so each one is only checked against its
+         // neighbours
+         SpatialIndex& placed = thread_index(scenario.width, scenario.height, 8.0 * scenario.R);
+         auto collides = [&](double x, double y) {
+            BBO_COUNT(collision_checks, 1);
+            return functions::coordinateCollidesWithObstacles(x, y, scenario) ||
+                   placed.collides(x, y);
          };
-         std::sort(layout_a.begin(), layout_a.end(), coord_compare);
-         std::sort(layout_b.begin(), layout_b.end(), coord_compare);
+         // the yield left over by the turbines of the child
+         std::unique_ptr<WakeShadow> shadow;
+         if (field) {
+            shadow.reset(new WakeShadow(*field));
+         }
 
-         // determine which layout has less turbines. the cutoff will be drawn from this
-         bool a_min = layout_a.size() < layout_b.size();
-         auto& min_layout = a_min ? layout_a : layout_b;
-         auto& max_layout = a_min ? layout_b : layout_a;
-         std::size_t min_size = min_layout.size();
-         std::size_t max_size = max_layout.size();
+         // combine each parent with the one next to it
+         for (auto it = parents.begin(); it != parents.end(); ++it) {
+            const auto& layout_a = (*(it))->layout;
+            const auto& layout_b = it + 1 == parents.end() ?
+               (*(parents.begin()))->layout : (*(it + 1))->layout;
+            std::size_t min_size = std::min(layout_a.size(), layout_b.size());
+            std::size_t max_size = std::max(layout_a.size(), layout_b.size());
 
-         // determine a random cutoff from [0, min_size]
-         // this is the number of turbines to copy from the first parent
-         //std::size_t size = std::min(layout_a.size(), layout_b.size());
-         std::uniform_int_distribution<std::size_t> dist_min(0, min_size);
-         std::size_t cutoff = dist_min(rng);
-         // if the size is below the maximum, add some additional turbines
-         // this prevents that we will eventually converge to low turbine individuals
-         std::uniform_int_distribution<std::size_t> dist_over(min_size, scenario.max_turbines);
-         std::size_t over = dist_over(rng);
-         std::size_t size = max_size < over ? max_size : over;
-         std::uniform_real_distribution<double> wdist(0.0, scenario.width);
-         std::uniform_real_distribution<double> hdist(0.0, scenario.height); 
+            // cut the farm by a line through a random point with a random
+            // direction, the child inherits the turbines of a on one side and
+            // those of b on the other
+            double px = wdist(rng);
+            double py = hdist(rng);
+            double angle = adist(rng);
+            double nx = std::cos(angle);
+            double ny = std::sin(angle);
+            auto side_a = [&](const coordinate& c) {
+               return (c.x - px) * nx + (c.y - py) * ny < 0.0;
+            };
 
-         individual child;
-         // copy [0, cutoff] turbines from min_layout
-         for (std::size_t i = 0; i < cutoff; ++i) {
-            child.layout.push_back(min_layout[i]);
-         }
-         // copy [cutoff, size] turbines from max_layout
-         for (std::size_t i = cutoff; i < size; ++i) {
-            auto& coord = max_layout[i];
-            if (!functions::turbine_collides(coord.x, coord.y, scenario, child.layout)) {
-               child.layout.push_back(coord);
+            // if the size is below the maximum, add some additional turbines
+            // this prevents that we will eventually converge to low turbine individuals
+            std::uniform_int_distribution<std::size_t> dist_over(min_size, scenario.max_turbines);
+            std::size_t over = dist_over(rng);
+            // the child inherits at most as many turbines as the larger
+            // parent has, or as over if that is smaller
+            std::size_t size = std::min(max_size, over);
+
+            individual child;
+            child.layout.reserve(std::max(max_size, over));
+            placed.clear();
+            // a's side is valid as it is, a subset of a valid layout
+            for (auto& coord : layout_a) {
+               if (child.layout.size() < size && side_a(coord)) {
+                  child.layout.push_back(coord);
+                  placed.insert(coord);
+               }
+            }
+            // b's side may collide with a's turbines next to the cut
+            for (auto& coord : layout_b) {
+               if (child.layout.size() < size && !side_a(coord) &&
+                   !collides(coord.x, coord.y)) {
+                  child.layout.push_back(coord);
+                  placed.insert(coord);
+               }
             }
-         }
          
-         // create [size, over] new turbines
-         std::size_t child_size = child.layout.size();
-         for (std::size_t i = child_size; i < over; ++i) {
-            double x = wdist(rng);
-            double y = hdist(rng);
-            if (!functions::turbine_collides(x, y, scenario, child.layout)) {
-               child.layout.push_back({ x, y });
+            // try to create new turbines up to over
+            std::size_t child_size = child.layout.size();
+            if (shadow) {
+               shadow->reset(child.layout);
+            }
+            for (std::size_t i = child_size; i < over; ++i) {
+               double x;
+               double y;
+               if (shadow) {
+                  shadow->draw(rng, x, y);
+               } else {
+                  x = wdist(rng);
+                  y = hdist(rng);
+               }
+               if (!collides(x, y)) {
+                  child.layout.push_back({ x, y, 0.0 });
+                  placed.insert(child.layout.back());
+                  if (shadow) {
+                     shadow->add(child.layout.back());
+                  }
+               }
             }
+
+            children.push_back(std::move(child));
          }
 
-         children.push_back(child);
+         return children;
       }
+   }
 
-      return children;
+   std::vector<individual> crossover(const std::vector<std::vector<individual>::iterator>& parents,
+                                     Scenario& scenario) {
+      return cut_and_fill(nullptr, parents, scenario);
+   }
+
+   std::vector<individual> crossover_sampled(
+      const WakeField& field,
+      const std::vector<std::vector<individual>::iterator>& parents,
+      Scenario& scenario) {
+      return cut_and_fill(&field, parents, scenario);
    }
 }
@@ -8,6 +8,7 @@
 
 #include "scenario.hpp"
 #include "structures.hpp"
+#include "wake_field.hpp"
 
 namespace recombination {
    /*
@@ -22,10 +23,15 @@ namespace recombination {
    /*
     * recombination::crossover
     *
-    * recombines parents by crossover
-    * first randomly determines a cutoff from [0, size]
-    * the childs turbines will then be copied from the parents,
-    * turbines with indices [0, cutoff] from parent a, [cutoff, size] from b
+    * recombines parents by a geometric crossover
+    * the farm is cut by a line through a random point with a random
+    * direction, the child gets the turbines of parent a on one side and
+    * those of parent b on the other, except the ones colliding with a's
+    * a random size is drawn from [smaller parent, max_turbines], the child
+    * inherits at most min(larger parent, size) turbines (a's side first),
+    * then new random turbines are tried once each up to the size
+    * the parents aren't changed, and with a spatial grid each child takes
+    * O(n) time
     *
     * parameters:
     * parents - the individuals which were selected for mating
@@ -34,6 +40,23 @@ namespace recombination {
    std::vector<individual> crossover(
       const std::vector<std::vector<individual>::iterator>& parents,
       Scenario& scenario);
+
+   /*
+    * recombination::crossover_sampled
+    *
+    * crossover, but the new turbines are drawn in proportion to the yield
+    * left over by the inherited ones and the new ones before them (see
+    * WakeShadow) instead of uniformly
+    *
+    * parameters:
+    * field - the wind exposure of the scenario
+    * parents - the individuals which were selected for mating
+    * scenario - the wind scenario
+    */
+   std::vector<individual> crossover_sampled(
+      const WakeField& field,
+      const std::vector<std::vector<individual>::iterator>& parents,
+      Scenario& scenario);
 }
 
 #endif
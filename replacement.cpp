@@ -72,4 +72,13 @@ namespace replacement {
                                      std::vector<individual>& children) {
       return children;
    }
+
+   void replace_worst(std::vector<individual>& population, individual& child) {
+      // the worst member has the highest fitness
+      auto worst = std::max_element(population.begin(), population.end(),
+         [](const individual& a, const individual& b) { return a.fitness < b.fitness; });
+      if (worst != population.end() && child.fitness < worst->fitness) {
+         *worst = child;
+      }
+   }
 }
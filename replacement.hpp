@@ -45,6 +45,18 @@ namespace replacement {
     */
    std::vector<individual> age_based(std::vector<individual>& old,
                                      std::vector<individual>& children);
+
+   /* replacement::replace_worst
+    *
+    * incremental replacement for the steady-state algorithm
+    * the child takes the place of the worst member of the population,
+    * but only if it is fitter than that member
+    *
+    * params:
+    * population - the population, is updated in place
+    * child - the evaluated child
+    */
+   void replace_worst(std::vector<individual>& population, individual& child);
 }
 
 #endif
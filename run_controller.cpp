@@ -0,0 +1,73 @@
+#include <cmath>
+#include <limits>
+
+#include "API/WindFarmLayoutEvaluator.h"
+#include "run_controller.hpp"
+
+RunController::RunController(WindFarmLayoutEvaluator& evaluator, const run_budget& budget)
+   : evaluator(evaluator),
+     budget(budget),
+     start_evaluations(evaluator.getNumberOfEvaluation()),
+     start_time(std::chrono::steady_clock::now()),
+     generation(0),
+     restart_count(0),
+     last_improvement(std::numeric_limits<double>::max()),
+     stagnant_generations(0) {}
+
+bool RunController::exhausted() {
+   if (budget.generations != 0 && generation >= budget.generations)
+      return true;
+   if (budget.evaluations > 0 && evaluations_used() >= budget.evaluations)
+      return true;
+   if (budget.seconds > 0.0 && seconds_used() >= budget.seconds)
+      return true;
+   return false;
+}
+
+int RunController::remaining_evaluations() {
+   if (budget.evaluations <= 0)
+      return std::numeric_limits<int>::max();
+   int remaining = budget.evaluations - evaluations_used();
+   return remaining > 0 ? remaining : 0;
+}
+
+int RunController::evaluations_used() {
+   return evaluator.getNumberOfEvaluation() - start_evaluations;
+}
+
+double RunController::seconds_used() const {
+   std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+   return elapsed.count();
+}
+
+bool RunController::next_generation(double fittest) {
+   generation++;
+   // the fitness is minimized, so an improvement is a relative decrease
+   double threshold = last_improvement - std::abs(last_improvement) * budget.min_improvement;
+   if (last_improvement == std::numeric_limits<double>::max() || fittest < threshold) {
+      last_improvement = fittest;
+      stagnant_generations = 0;
+   } else {
+      stagnant_generations++;
+   }
+   return budget.stagnation_generations > 0 &&
+      stagnant_generations >= budget.stagnation_generations;
+}
+
+void RunController::restart() {
+   restart_count++;
+   stagnant_generations = 0;
+}
+
+std::string RunController::stop_reason() {
+   if (budget.generations != 0 && generation >= budget.generations)
+      return "generation limit reached";
+   if (budget.evaluations > 0 && evaluations_used() >= budget.evaluations)
+      return "evaluation budget used up";
+   if (budget.seconds > 0.0 && seconds_used() >= budget.seconds)
+      return "time limit reached";
+   if (budget.stagnation_generations > 0 &&
+       stagnant_generations >= budget.stagnation_generations)
+      return "no improvement for " + std::to_string(stagnant_generations) + " generations";
+   return "not stopped";
+}
@@ -0,0 +1,105 @@
+/*
+ * run_controller.hpp
+ *
+ * contains the budget of a run of the evolutionary algorithm and the
+ * controller which decides when the run stops or restarts
+ */
+#ifndef BBO_RUN_CONTROLLER_HPP
+#define BBO_RUN_CONTROLLER_HPP
+
+#include <chrono>
+#include <string>
+
+class WindFarmLayoutEvaluator;
+
+/* struct run_budget
+ *
+ * the limits of a run, a limit of 0 means that there is no such limit
+ * (a negative number of generations allows no generation at all)
+ * at least one of generations, evaluations and seconds should be set,
+ * otherwise the run only ends by stagnation
+ */
+struct run_budget {
+   // the maximum number of generations
+   int generations;
+   // the maximum number of calls of the evaluator, including the initialization
+   int evaluations;
+   // the maximum wall-clock time in seconds
+   double seconds;
+   // the number of generations without improvement after which the run stagnated
+   int stagnation_generations;
+   // the relative improvement of the fittest member which counts as progress
+   double min_improvement;
+   // if true, a stagnated run is restarted instead of stopped
+   bool restart_on_stagnation;
+};
+
+/*
+ * RunController
+ *
+ * keeps track of the budget of a run
+ * the evaluations are taken from evaluator.getNumberOfEvaluation(), so every
+ * evaluation is counted no matter where in the algorithm it happened
+ */
+class RunController {
+public:
+   /*
+    * the run starts when the controller is constructed,
+    * so construct it right before the initialization
+    */
+   RunController(WindFarmLayoutEvaluator& evaluator, const run_budget& budget);
+
+   /*
+    * returns true if the generations, evaluations or time are used up
+    */
+   bool exhausted();
+
+   /*
+    * returns the number of evaluations which may still be used
+    * or the maximum int if there is no evaluation limit
+    */
+   int remaining_evaluations();
+
+   // the number of evaluations used since the start of the run
+   int evaluations_used();
+
+   // the wall-clock time since the start of the run in seconds
+   double seconds_used() const;
+
+   /*
+    * RunController::next_generation
+    *
+    * has to be called after each generation with the fittest fitness so far
+    *
+    * returns:
+    *    true if the run has stagnated
+    */
+   bool next_generation(double fittest);
+
+   /*
+    * RunController::restart
+    *
+    * resets the stagnation tracking after the population was restarted
+    */
+   void restart();
+
+   // a description of why exhausted() returned true or the run stagnated
+   std::string stop_reason();
+
+   int generations() const { return generation; }
+   int restarts() const { return restart_count; }
+
+private:
+   WindFarmLayoutEvaluator& evaluator;
+   run_budget budget;
+   int start_evaluations;
+   std::chrono::steady_clock::time_point start_time;
+   int generation;
+   int restart_count;
+   // the fittest fitness at the last generation which improved it
+   double last_improvement;
+   // the number of generations since then
+   int stagnant_generations;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#include "spatial_index.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+SpatialIndex::SpatialIndex(double width, double height, double min_distance)
+   : min_distance(min_distance),
+     size_(min_distance / std::sqrt(2.0)),
+     cols(std::max(1, static_cast<int>(std::ceil(width / size_)))),
+     rows(std::max(1, static_cast<int>(std::ceil(height / size_)))),
+     heads(cols * rows, -1) {
+}
+
+void SpatialIndex::clear() {
+   std::fill(heads.begin(), heads.end(), -1);
+   next.clear();
+   turbines.clear();
+}
+
+void SpatialIndex::reset(double width, double height, double min_distance) {
+   this->min_distance = min_distance;
+   size_ = min_distance / std::sqrt(2.0);
+   cols = std::max(1, static_cast<int>(std::ceil(width / size_)));
+   rows = std::max(1, static_cast<int>(std::ceil(height / size_)));
+   heads.assign(cols * rows, -1);
+   next.clear();
+   turbines.clear();
+}
+
+int SpatialIndex::column(double x) const {
+   return std::min(cols - 1, std::max(0, static_cast<int>(std::floor(x / size_))));
+}
+
+int SpatialIndex::row(double y) const {
+   return std::min(rows - 1, std::max(0, static_cast<int>(std::floor(y / size_))));
+}
+
+void SpatialIndex::insert(const coordinate& turbine) {
+   int cell = row(turbine.y) * cols + column(turbine.x);
+   next.push_back(heads[cell]);
+   heads[cell] = turbines.size();
+   turbines.push_back(turbine);
+}
+
+bool SpatialIndex::collides(double x, double y) const {
+   int c = column(x);
+   int r = row(y);
+   double limit = min_distance * min_distance;
+   for (int rr = std::max(0, r - 2); rr <= std::min(rows - 1, r + 2); ++rr) {
+      for (int cc = std::max(0, c - 2); cc <= std::min(cols - 1, c + 2); ++cc) {
+         for (int i = heads[rr * cols + cc]; i != -1; i = next[i]) {
+            double dx = turbines[i].x - x;
+            double dy = turbines[i].y - y;
+            if (dx * dx + dy * dy < limit)
+               return true;
+         }
+      }
+   }
+   return false;
+}
+
+SpatialIndex& thread_index(double width, double height, double min_distance) {
+   thread_local SpatialIndex index(width, height, min_distance);
+   index.reset(width, height, min_distance);
+   return index;
+}
@@ -0,0 +1,68 @@
+/*
+ * spatial_index.hpp
+ *
+ * contains a uniform grid over the farm, which answers whether a position
+ * is too close to one of the turbines already placed in constant time
+ */
+#ifndef BBO_SPATIAL_INDEX_HPP
+#define BBO_SPATIAL_INDEX_HPP
+
+#include <vector>
+
+#include "structures.hpp"
+
+/*
+ * SpatialIndex
+ *
+ * buckets the turbines into square cells of min_distance / sqrt(2), so that
+ * two valid turbines never share a cell and only the 5 x 5 cells around a
+ * position have to be checked. positions outside of the farm are clamped to
+ * the border cells, so they are still found
+ */
+class SpatialIndex {
+public:
+   SpatialIndex(double width, double height, double min_distance);
+
+   // removes all turbines
+   void clear();
+   // removes all turbines and changes the grid, keeping the allocated memory
+   // when the new grid isn't larger
+   void reset(double width, double height, double min_distance);
+   void insert(const coordinate& turbine);
+
+   /*
+    * SpatialIndex::collides
+    *
+    * returns:
+    *    true if a turbine of the index is closer than min_distance to (x, y)
+    */
+   bool collides(double x, double y) const;
+
+   std::size_t size() const { return turbines.size(); }
+   const std::vector<coordinate>& layout() const { return turbines; }
+
+private:
+   int column(double x) const;
+   int row(double y) const;
+
+   double min_distance;
+   double size_;
+   int cols;
+   int rows;
+   // the first turbine of each cell, -1 if the cell is empty
+   std::vector<int> heads;
+   // the next turbine in the same cell, -1 at the end
+   std::vector<int> next;
+   std::vector<coordinate> turbines;
+};
+
+/*
+ * thread_index
+ *
+ * returns the spatial index of the calling thread, emptied and fitted to the
+ * given grid. it keeps its memory between the calls, so operators which use
+ * it as their workspace stop allocating once it is warm
+ */
+SpatialIndex& thread_index(double width, double height, double min_distance);
+
+#endif
@@ -0,0 +1,78 @@
+/*
+ * spsc_queue.hpp
+ *
+ * contains a bounded lock-free queue for exactly one producer thread
+ * and one consumer thread
+ */
+#ifndef BBO_SPSC_QUEUE_HPP
+#define BBO_SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/*
+ * SpscQueue
+ *
+ * a ring buffer with one slot kept free to tell a full queue from an empty one
+ * the producer only writes tail, the consumer only writes head, so neither
+ * push nor pop ever block or lock
+ */
+template<typename T>
+class SpscQueue {
+public:
+   explicit SpscQueue(std::size_t capacity)
+      : slots(capacity + 1), head(0), tail(0) {}
+
+   SpscQueue(const SpscQueue&) = delete;
+   SpscQueue& operator=(const SpscQueue&) = delete;
+
+   /*
+    * SpscQueue::push
+    *
+    * may only be called by the producer
+    *
+    * returns:
+    *    false if the queue is full, the value is dropped then
+    */
+   bool push(const T& value) {
+      std::size_t current = tail.load(std::memory_order_relaxed);
+      std::size_t next = (current + 1) % slots.size();
+      if (next == head.load(std::memory_order_acquire))
+         return false;
+      slots[current] = value;
+      tail.store(next, std::memory_order_release);
+      return true;
+   }
+
+   /*
+    * SpscQueue::pop
+    *
+    * may only be called by the consumer
+    *
+    * returns:
+    *    false if the queue is empty, value is left untouched then
+    */
+   bool pop(T& value) {
+      std::size_t current = head.load(std::memory_order_relaxed);
+      if (current == tail.load(std::memory_order_acquire))
+         return false;
+      value = std::move(slots[current]);
+      head.store((current + 1) % slots.size(), std::memory_order_release);
+      return true;
+   }
+
+private:
+   // the size of a cache line, the padding keeps the producer and consumer
+   // indices on separate lines. new doesn't honor an alignas above that of
+   // max_align_t before C++17, so the bytes are spelled out instead
+   static const std::size_t CACHE_LINE = 64;
+   std::vector<T> slots;
+   char head_padding[CACHE_LINE];
+   std::atomic<std::size_t> head;
+   char tail_padding[CACHE_LINE];
+   std::atomic<std::size_t> tail;
+   char end_padding[CACHE_LINE];
+};
+
+#endif
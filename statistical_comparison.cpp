@@ -3,10 +3,12 @@
 #include <iostream>
 #include <limits>
 #include <map>
+#include <memory>
 #include <string>
 #include <map>
 
 #include "API/WindScenario.h"
+#include "API/CompiledScenario.h"
 #include "API/KusiakLayoutEvaluator.h"
 
 #include "structures.hpp"
@@ -42,6 +44,11 @@ void statistical_comparison(int pop_size,
       { "fitness-based", std::bind(replacement::replacement_1, _1, _2, pop_size) }
    };
 
+   // the scenario is read once, every evaluator shares its constants
+   std::shared_ptr<const CompiledScenario> compiled = CompiledScenario::load(sc_name);
+   WindScenario wscenario(compiled->scenario);
+   Scenario scenario(wscenario);
+
    // to keep track of the completed ea runs
    int run = 1;
    // to store the results for each combination
@@ -61,10 +68,6 @@ void statistical_comparison(int pop_size,
                      .append(replace.first);
                   std::cout << "Testing " << name << std::endl;
 
-                  // create a scenario
-                  WindScenario wscenario(sc_name);
-                  Scenario scenario(wscenario);
-
                   // run the algorithm on the scenario
                   // hold the fitness results in a vector
                   std::vector<double> fitnesses;
@@ -73,7 +76,7 @@ void statistical_comparison(int pop_size,
                   for (int j = 0; j < iterations; ++j) {
                      // create an evaluator for this run
                      KusiakLayoutEvaluator evaluator;
-                     evaluator.initialize(wscenario);
+                     evaluator.initialize(compiled);
                      // run the ea and store the improvement
                      double fitness = evolutionary_algorithm(
                         evaluator, scenario, init.second, select.second,
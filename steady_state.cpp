@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+#include "API/WindFarmLayoutEvaluator.h"
+#include "functions.hpp"
+#include "instrumentation.hpp"
+#include "scenario.hpp"
+#include "steady_state.hpp"
+#include "thread_pool.hpp"
+
+std::pair<double, double> steady_state_algorithm(
+                                  WindFarmLayoutEvaluator& evaluator,
+                                  evaluator_factory make_evaluator,
+                                  int workers,
+                                  Scenario& scenario,
+                                  initialization_func initialize,
+                                  selection_func select,
+                                  recombination_func recombine,
+                                  mutation_func mutate,
+                                  insertion_func insert,
+                                  const run_budget& budget) {
+   // evaluators keep the state of their last evaluation, so every worker
+   // needs its own. they are created before the run starts, because
+   // initializing an evaluator resets the evaluation counter
+   std::vector<std::unique_ptr<WindFarmLayoutEvaluator>> evaluators;
+   // the evaluated children which haven't been inserted yet
+   std::deque<individual> results;
+   std::mutex results_mutex;
+   std::condition_variable result_ready;
+   // the time the workers spent working, to determine the utilization
+   std::atomic<long long> busy_ns(0);
+
+   // declared after everything its tasks use, so that its destructor
+   // waits for the workers before those are destroyed
+   ThreadPool pool(workers);
+   for (int w = 0; w < pool.size(); ++w) {
+      evaluators.push_back(make_evaluator());
+   }
+
+   // the run starts now, so that the evaluations of the initialization count
+   RunController controller(evaluator, budget);
+   std::vector<individual> population;
+   {
+      BBO_TIME_PHASE(initialize);
+      population = initialize(evaluator, scenario);
+   }
+   if (population.empty())
+      return{ 0.0, 0.0 };
+
+   // the best (lowest) fittness
+   double fittest = population.begin()->fitness;
+   for (auto& indiv : population) {
+      fittest = std::min(fittest, indiv.fitness);
+   }
+   double initial_fittest = fittest;
+   std::cout << "Initial fittest: " << fittest << std::endl;
+
+   // the children which haven't been handed to a worker yet
+   std::vector<individual> pending;
+   // the number of children being worked on
+   int in_flight = 0;
+   // the number of children handed to the workers so far
+   int dispatched = 0;
+   // the number of children inserted so far
+   int inserted = 0;
+   bool stagnated = false;
+
+   // from now on every evaluation belongs to a dispatched child,
+   // so counting them is exact even while some are still running
+   int dispatch_budget = controller.remaining_evaluations();
+   // true if another child may be evaluated within the budget
+   auto can_dispatch = [&]() {
+      return !stagnated && dispatched < dispatch_budget && !controller.exhausted();
+   };
+   // hands the next child to the next free worker
+   auto dispatch = [&]() {
+      if (pending.empty()) {
+         std::vector<std::vector<individual>::iterator> parents;
+         {
+            BBO_TIME_PHASE(select);
+            parents = select(population);
+         }
+         BBO_TIME_PHASE(recombine);
+         pending = recombine(parents, scenario);
+      }
+      individual child = pending.back();
+      pending.pop_back();
+      in_flight++;
+      dispatched++;
+      pool.submit([&, child](int worker) mutable {
+         auto start = std::chrono::steady_clock::now();
+         {
+            BBO_TIME_PHASE(mutate);
+            mutate(child, scenario);
+         }
+         {
+            BBO_TIME_PHASE(remove_illegal);
+            functions::remove_illegal_coordinates(child, scenario);
+         }
+         {
+            BBO_TIME_PHASE(evaluate);
+            functions::evaluate_individual(*evaluators[worker], child);
+         }
+         busy_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+         {
+            // notified under the lock, so the master can't return and
+            // destroy the condition variable in between
+            std::lock_guard<std::mutex> lock(results_mutex);
+            results.push_back(child);
+            result_ready.notify_one();
+         }
+      });
+   };
+
+   auto start = std::chrono::steady_clock::now();
+   // give every worker something to do
+   while (in_flight < pool.size() && can_dispatch()) {
+      dispatch();
+   }
+   while (in_flight > 0) {
+      individual child;
+      {
+         std::unique_lock<std::mutex> lock(results_mutex);
+         result_ready.wait(lock, [&] { return !results.empty(); });
+         child = results.front();
+         results.pop_front();
+      }
+      in_flight--;
+
+      // incremental replacement step
+      {
+         BBO_TIME_PHASE(replace);
+         insert(population, child);
+      }
+      fittest = std::min(fittest, child.fitness);
+      std::cout << child.fitness << " : " << child.layout.size() << std::endl;
+
+      // a population worth of children counts as a generation
+      if (++inserted % population.size() == 0) {
+         std::cout << "Fittest after " << inserted << " children : " << fittest << std::endl;
+         BBO_REPORT_GENERATION(controller.generations() + 1);
+         if (controller.next_generation(fittest)) {
+            std::cout << "Stagnated: " << controller.stop_reason() << std::endl;
+            stagnated = true;
+         }
+      }
+
+      // the worker which delivered the child is free again
+      if (can_dispatch()) {
+         dispatch();
+      }
+   }
+
+   std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+   double utilization = busy_ns / (elapsed.count() * 1.0e9 * pool.size());
+   std::cout << "Stopped after " << inserted << " children, "
+             << controller.evaluations_used() << " evaluations and "
+             << controller.seconds_used() << "s: " << controller.stop_reason() << std::endl;
+   std::cout << "Worker utilization: " << utilization * 100.0 << "% of "
+             << pool.size() << " workers" << std::endl;
+   BBO_REPORT_TOTAL();
+
+   return{ fittest, initial_fittest - fittest };
+}
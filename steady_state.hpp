@@ -0,0 +1,55 @@
+/*
+ * steady_state.hpp
+ *
+ * contains the asynchronous steady-state variant of the evolutionary algorithm
+ */
+#ifndef BBO_STEADY_STATE_HPP
+#define BBO_STEADY_STATE_HPP
+
+#include "evolutionary_algorithm.hpp"
+#include "run_controller.hpp"
+
+/*
+ * steady_state_algorithm
+ *
+ * executes an evolutionary algorithm without generation barriers
+ * the master thread keeps a queue of children (created with select and
+ * recombine from the current population) and hands them out one at a time.
+ * a worker mutates, repairs and evaluates a child with its own evaluator,
+ * the master inserts each result into the population as soon as it arrives
+ * and immediately gives the worker a new child. this way no worker waits for
+ * a slower one, even though the evaluation time grows with the turbine count
+ *
+ * the budget works like in evolutionary_algorithm, with a "generation" being
+ * as many inserted children as there are members in the population.
+ * the evaluation budget is never exceeded. a stagnated run is always stopped
+ *
+ * parameters:
+ * evaluator - the layout evaluator, used for the initialization
+ * make_evaluator - creates the evaluator of each worker
+ * workers - the number of worker threads, 0 for one per hardware thread
+ * scenario - the wind scenario to solve
+ * initialize - function which initializes the population
+ * select - function which selects the parents
+ * recombine - function which recombines parents
+ * mutate - function which mutates children, runs on the workers
+ * insert - function which inserts a child into the population
+ * budget - the limits of the run
+ *
+ * returns:
+ * fittest, improvement - the best fitness overall and the improvement from
+ *                        the initial best fitness to the final one
+ */
+std::pair<double, double> steady_state_algorithm(
+                                  WindFarmLayoutEvaluator& evaluator,
+                                  evaluator_factory make_evaluator,
+                                  int workers,
+                                  Scenario& scenario,
+                                  initialization_func initialize,
+                                  selection_func select,
+                                  recombination_func recombine,
+                                  mutation_func mutate,
+                                  insertion_func insert,
+                                  const run_budget& budget);
+
+#endif
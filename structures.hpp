@@ -18,6 +18,9 @@
 struct coordinate{
   double x;
   double y;
+  // the wake free ratio of the turbine in the last evaluated layout
+  // it was part of, 0 if it wasn't evaluated yet
+  double wake_free_ratio;
 };
 
 /* struct individual
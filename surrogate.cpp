@@ -0,0 +1,132 @@
+#include "surrogate.hpp"
+#include "API/WindFarmLayoutEvaluator.h"
+#include "functions.hpp"
+#include "instrumentation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numeric>
+
+namespace {
+   // the weight of a new sample in the running averages
+   const double RATE = 0.1;
+}
+
+Surrogate::Surrogate(std::shared_ptr<const CompiledScenario> compiled,
+                     const surrogate_config& config)
+   : compiled(compiled), config(config), selected_free_energy(0.0), scale(1.0),
+     mean_error(0.0), samples(0), fallback_left(0), rejected_children(0) {
+   // the directions by the energy they carry without any wake
+   const std::vector<double>& free_energy = compiled->directionFreeEnergy;
+   directions = compiled->directionOrder;
+   double total = std::accumulate(free_energy.begin(), free_energy.end(), 0.0);
+   std::size_t count = 0;
+   while (count < directions.size() &&
+          (count == 0 || selected_free_energy < config.direction_share * total)) {
+      selected_free_energy += free_energy[directions[count]];
+      ++count;
+   }
+   directions.resize(count);
+}
+
+double Surrogate::approximate(const std::vector<coordinate>& layout) {
+   int n = layout.size();
+   if (n == 0)
+      return std::numeric_limits<double>::max();
+   const WindScenario& scenario = compiled->scenario;
+   const WakeCone& cone = compiled->cone;
+   int k = std::min(config.neighbours, n - 1);
+
+   std::vector<std::pair<double, int>> nearest(n);
+   double energy = 0.0;
+   for (int i = 0; i < n; ++i) {
+      // the k nearest other turbines are the only possible wake sources
+      int m = 0;
+      for (int j = 0; j < n; ++j) {
+         if (j == i)
+            continue;
+         double dx = layout[i].x - layout[j].x;
+         double dy = layout[i].y - layout[j].y;
+         nearest[m++] = { dx * dx + dy * dy, j };
+      }
+      std::nth_element(nearest.begin(), nearest.begin() + k, nearest.begin() + m);
+
+      for (int d : directions) {
+         double cos_t = scenario.getCosMidThetas(d);
+         double sin_t = scenario.getSinMidThetas(d);
+         double deficit = 0.0;
+         for (int s = 0; s < k; ++s) {
+            const coordinate& o = layout[nearest[s].second];
+            double def = cone.deficit(cos_t, sin_t, layout[i].x - o.x, layout[i].y - o.y);
+            deficit += def * def;
+         }
+         energy += compiled->directionPower<double>(d, scenario.c.get(0, d) *
+                                                    (1.0 - std::sqrt(deficit)));
+      }
+   }
+   return compiled->costOfEnergy(n, energy / (selected_free_energy * n));
+}
+
+double Surrogate::predict(const individual& indiv) {
+   return scale * approximate(indiv.layout);
+}
+
+void Surrogate::record(double raw, double exact) {
+   const double invalid = std::numeric_limits<double>::max();
+   if (raw == invalid || exact == invalid)
+      return;
+   if (samples == 0) {
+      scale = exact / raw;
+   } else {
+      double err = std::abs(scale * raw - exact) / exact;
+      mean_error = samples == 1 ? err : (1.0 - RATE) * mean_error + RATE * err;
+      scale = (1.0 - RATE) * scale + RATE * exact / raw;
+   }
+   ++samples;
+}
+
+void Surrogate::evaluate(WindFarmLayoutEvaluator& evaluator, std::vector<individual>& children,
+                         int generation) {
+   bool screening = samples >= config.warmup && fallback_left == 0;
+   if (fallback_left > 0)
+      --fallback_left;
+
+   std::vector<double> raw(children.size());
+   for (std::size_t i = 0; i < children.size(); ++i) {
+      raw[i] = approximate(children[i].layout);
+   }
+   std::vector<std::size_t> order(children.size());
+   std::iota(order.begin(), order.end(), 0);
+   std::size_t promoted = children.size();
+   if (screening) {
+      // the scale doesn't change the ranking
+      std::sort(order.begin(), order.end(),
+                [&](std::size_t a, std::size_t b) { return raw[a] < raw[b]; });
+      promoted = std::max<std::size_t>(1, std::ceil(config.promote_fraction * children.size()));
+   }
+
+   // only the promoted children are kept, so that no child without an
+   // exact fitness can enter the population
+   std::vector<individual> evaluated;
+   evaluated.reserve(promoted);
+   for (std::size_t k = 0; k < order.size(); ++k) {
+      individual& child = children[order[k]];
+      if (k < promoted) {
+         record(raw[order[k]], functions::evaluate_individual(evaluator, child));
+         evaluated.push_back(std::move(child));
+      } else {
+         ++rejected_children;
+         BBO_COUNT(surrogate_rejections, 1);
+      }
+   }
+   children.swap(evaluated);
+
+   if (screening && mean_error > config.max_error) {
+      fallback_left = config.fallback_generations;
+      std::cout << "Surrogate error " << mean_error << " above " << config.max_error
+                << " at generation " << generation << ", evaluating exactly for "
+                << fallback_left << " generations" << std::endl;
+   }
+}
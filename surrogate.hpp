@@ -0,0 +1,105 @@
+/*
+ * surrogate.hpp
+ *
+ * contains a cheap approximation of the Kusiak wake model, which is used to
+ * pre-screen offspring before they are sent to the exact evaluator
+ */
+#ifndef BBO_SURROGATE_HPP
+#define BBO_SURROGATE_HPP
+
+#include <memory>
+#include <vector>
+
+#include "API/CompiledScenario.h"
+#include "structures.hpp"
+
+class WindFarmLayoutEvaluator;
+
+/* struct surrogate_config
+ *
+ * the accuracy of the approximation and the screening policy
+ */
+struct surrogate_config {
+   // the number of nearest turbines which may shadow a turbine
+   int neighbours;
+   // the directions are taken by decreasing weight until they cover this
+   // share of the wake free energy (1.0 for all directions)
+   double direction_share;
+   // the share of the children of a generation sent to the exact evaluator
+   double promote_fraction;
+   // the number of exact evaluations the surrogate is calibrated on before
+   // it starts to screen
+   int warmup;
+   // the mean relative error above which the surrogate stops screening
+   double max_error;
+   // the number of generations everything is evaluated exactly after that
+   int fallback_generations;
+};
+
+/*
+ * Surrogate
+ *
+ * approximates the cost of energy of a layout with the wake model of
+ * KusiakLayoutEvaluator, but only for the most important directions and
+ * only with the nearest turbines as wake sources. the raw approximation is
+ * biased, so it is scaled by a running average of exact / approximate cost
+ * which is learned from every exact evaluation
+ *
+ * the relative error of the scaled prediction is tracked the same way; when
+ * it exceeds max_error, all children are evaluated exactly for a while
+ */
+class Surrogate {
+public:
+   Surrogate(std::shared_ptr<const CompiledScenario> compiled, const surrogate_config& config);
+
+   /*
+    * Surrogate::predict
+    *
+    * returns:
+    *    the predicted cost of energy of the layout
+    */
+   double predict(const individual& indiv);
+
+   /*
+    * Surrogate::evaluate
+    *
+    * evaluates the children of a generation (see evaluation_func): ranks
+    * them by their prediction and evaluates only the promising fraction
+    * exactly. the others are removed from children, so that only exactly
+    * evaluated children reach the replacement. while calibrating or falling
+    * back, every child is evaluated exactly
+    *
+    * parameters:
+    *    evaluator - the exact evaluator
+    *    children - the children to evaluate
+    *    generation - the current generation
+    */
+   void evaluate(WindFarmLayoutEvaluator& evaluator, std::vector<individual>& children,
+                 int generation);
+
+   // the current mean relative error of the predictions
+   double error() const { return mean_error; }
+   // the number of children which were not evaluated exactly
+   int rejected() const { return rejected_children; }
+
+private:
+   // the approximate cost of energy, before scaling
+   double approximate(const std::vector<coordinate>& layout);
+   // learns from an exact evaluation
+   void record(double raw, double exact);
+
+   std::shared_ptr<const CompiledScenario> compiled;
+   surrogate_config config;
+   // the directions which are evaluated, by decreasing weight
+   std::vector<int> directions;
+   // the wake free energy of those directions, for the approximate ratio
+   double selected_free_energy;
+   // exact / approximate cost, averaged
+   double scale;
+   double mean_error;
+   int samples;
+   int fallback_left;
+   int rejected_children;
+};
+
+#endif
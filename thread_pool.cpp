@@ -0,0 +1,100 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+ThreadPool::ThreadPool(int threads)
+   : unfinished(0),
+     stopping(false) {
+   if (threads <= 0) {
+      threads = std::thread::hardware_concurrency();
+   }
+   // hardware_concurrency may return 0 if it is unknown
+   if (threads <= 0) {
+      threads = 1;
+   }
+   for (int i = 0; i < threads; ++i) {
+      workers.emplace_back(&ThreadPool::work, this, i);
+   }
+}
+
+ThreadPool::~ThreadPool() {
+   wait();
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+   }
+   task_available.notify_all();
+   for (auto& worker : workers) {
+      worker.join();
+   }
+}
+
+void ThreadPool::submit(std::function<void(int)> task) {
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      tasks.push_back(std::move(task));
+      unfinished++;
+   }
+   task_available.notify_one();
+}
+
+void ThreadPool::wait() {
+   std::unique_lock<std::mutex> lock(mutex);
+   tasks_done.wait(lock, [this] { return unfinished == 0; });
+}
+
+void ThreadPool::parallel_for(int count, const std::function<void(int)>& body) {
+   // shared with the helper tasks, which may only start after this returned
+   struct loop {
+      std::function<void(int)> body;
+      std::atomic<int> next;
+      std::atomic<int> done;
+      std::mutex mutex;
+      std::condition_variable finished;
+   };
+   auto state = std::make_shared<loop>();
+   state->body = body;
+   state->next = 0;
+   state->done = 0;
+   auto run = [state, count](int) {
+      for (int i = state->next++; i < count; i = state->next++) {
+         state->body(i);
+         if (++state->done == count) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->finished.notify_all();
+         }
+      }
+   };
+   for (int helper = std::min(size(), count - 1); helper > 0; --helper) {
+      submit(run);
+   }
+   run(-1);
+   std::unique_lock<std::mutex> lock(state->mutex);
+   state->finished.wait(lock, [&] { return state->done == count; });
+}
+
+void ThreadPool::work(int index) {
+   while (true) {
+      std::function<void(int)> task;
+      {
+         std::unique_lock<std::mutex> lock(mutex);
+         task_available.wait(lock, [this] { return stopping || !tasks.empty(); });
+         if (tasks.empty()) {
+            // stopping and nothing left to do
+            return;
+         }
+         task = std::move(tasks.front());
+         tasks.pop_front();
+      }
+      task(index);
+      {
+         std::lock_guard<std::mutex> lock(mutex);
+         unfinished--;
+         if (unfinished == 0) {
+            tasks_done.notify_all();
+         }
+      }
+   }
+}
@@ -0,0 +1,83 @@
+/*
+ * thread_pool.hpp
+ *
+ * contains a fixed size pool of worker threads
+ */
+#ifndef BBO_THREAD_POOL_HPP
+#define BBO_THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * ThreadPool
+ *
+ * runs submitted tasks on a fixed number of worker threads
+ * each task receives the index of the worker which runs it [0, size()),
+ * so that tasks can use per-worker state (e.g. one evaluator per worker)
+ * without any locking
+ */
+class ThreadPool {
+public:
+   /*
+    * starts the worker threads
+    *
+    * parameters:
+    *    threads - the number of workers, 0 for one per hardware thread
+    */
+   explicit ThreadPool(int threads = 0);
+
+   /*
+    * waits for all submitted tasks, then stops the workers
+    */
+   ~ThreadPool();
+
+   ThreadPool(const ThreadPool&) = delete;
+   ThreadPool& operator=(const ThreadPool&) = delete;
+
+   // the number of worker threads
+   int size() const { return workers.size(); }
+
+   /*
+    * ThreadPool::submit
+    *
+    * queues a task, it will be run by the next free worker
+    */
+   void submit(std::function<void(int)> task);
+
+   /*
+    * ThreadPool::wait
+    *
+    * blocks until all submitted tasks have finished
+    */
+   void wait();
+
+   /*
+    * ThreadPool::parallel_for
+    *
+    * runs body(i) for each i in [0, count) on the workers and the calling
+    * thread, and returns when all of them have finished. unlike wait, it
+    * doesn't wait for other tasks, and it is safe to call from a worker:
+    * the calling thread takes the indices the workers don't get to
+    * (see KusiakLayoutEvaluator::setParallelFor)
+    */
+   void parallel_for(int count, const std::function<void(int)>& body);
+
+private:
+   void work(int index);
+
+   std::vector<std::thread> workers;
+   std::deque<std::function<void(int)>> tasks;
+   std::mutex mutex;
+   std::condition_variable task_available;
+   std::condition_variable tasks_done;
+   // the number of tasks which are queued or running
+   int unfinished;
+   bool stopping;
+};
+
+#endif
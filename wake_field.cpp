@@ -0,0 +1,226 @@
+#include "wake_field.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+   // the number of directions used when the wind resource is unknown
+   const int UNIFORM_DIRECTIONS = 24;
+   // wakes are ignored where their velocity deficit falls below this
+   const double WAKE_CUTOFF = 0.02;
+}
+
+WakeField::WakeField(std::shared_ptr<const CompiledScenario> compiled)
+   : cone(compiled->cone) {
+   const WindScenario& scenario = compiled->scenario;
+   // the energy of a direction grows with the mean cube of the wind speed,
+   // which is c^3 * gamma(1 + 3 / k) for a weibull distribution
+   double total = 0.0;
+   for (unsigned int d = 0; d < scenario.thetas.rows; ++d) {
+      double c = scenario.c.get(0, d);
+      double k = scenario.ks.get(0, d);
+      cos_t.push_back(scenario.getCosMidThetas(d));
+      sin_t.push_back(scenario.getSinMidThetas(d));
+      weights.push_back(scenario.directionWeights[d] * c * c * c * std::tgamma(1.0 + 3.0 / k));
+      total += weights.back();
+   }
+   for (auto& w : weights) {
+      w /= total;
+   }
+   init_raster(scenario.R, scenario.width, scenario.height, scenario.obstacles);
+}
+
+WakeField::WakeField(CompetitionScenario& scenario)
+   : cone(scenario.k, scenario.R, scenario.CT) {
+   for (int d = 0; d < UNIFORM_DIRECTIONS; ++d) {
+      double theta = (d + 0.5) * 2.0 * M_PI / UNIFORM_DIRECTIONS;
+      cos_t.push_back(std::cos(theta));
+      sin_t.push_back(std::sin(theta));
+      weights.push_back(1.0 / UNIFORM_DIRECTIONS);
+   }
+   init_raster(scenario.R, scenario.width, scenario.height, scenario.obstacles);
+}
+
+void WakeField::init_raster(double R, double width, double height,
+                            const Matrix<double>& obstacles) {
+   radius = R;
+   // a / (1 + k / R * x)^2 = WAKE_CUTOFF
+   length = std::max(0.0, (std::sqrt(cone.velocityDeficit / WAKE_CUTOFF) - 1.0) / cone.krRatio);
+   farm_width = width;
+   farm_height = height;
+   size = min_distance();
+   cols = std::max(1, static_cast<int>(std::ceil(width / size)));
+   rws = std::max(1, static_cast<int>(std::ceil(height / size)));
+   exposures.assign(cols * rws, 0.0);
+   for (int r = 0; r < rws; ++r) {
+      for (int c = 0; c < cols; ++c) {
+         double x0 = c * size;
+         double y0 = r * size;
+         double x1 = std::min(x0 + size, width);
+         double y1 = std::min(y0 + size, height);
+         double area = (x1 - x0) * (y1 - y0);
+         // overlapping obstacles are rare, their overlap is counted twice
+         for (unsigned int o = 0; o < obstacles.rows; ++o) {
+            double ox = std::min(x1, obstacles.get(o, 2)) - std::max(x0, obstacles.get(o, 0));
+            double oy = std::min(y1, obstacles.get(o, 3)) - std::max(y0, obstacles.get(o, 1));
+            if (ox > 0.0 && oy > 0.0)
+               area -= ox * oy;
+         }
+         exposures[r * cols + c] = std::max(0.0, area / (size * size));
+      }
+   }
+}
+
+WakeShadow::WakeShadow(const WakeField& field)
+   : field(field) {
+   reset(std::vector<coordinate>());
+}
+
+void WakeShadow::reset(const std::vector<coordinate>& layout) {
+   int cells = field.columns() * field.rows();
+   deficits.assign(cells * field.directions(), 0.0);
+   blockers.assign(cells, 0);
+   yields.assign(cells, 0.0);
+   tree.assign(cells + 1, 0.0);
+   // the yields without any turbine, the tree is built in linear time
+   for (int cell = 0; cell < cells; ++cell) {
+      yields[cell] = field.exposure(cell);
+      tree[cell + 1] += yields[cell];
+      int parent = (cell + 1) + ((cell + 1) & -(cell + 1));
+      if (parent <= cells)
+         tree[parent] += tree[cell + 1];
+   }
+   for (auto& turbine : layout) {
+      add(turbine);
+   }
+}
+
+void WakeShadow::add(const coordinate& turbine) {
+   update(turbine, 1);
+}
+
+void WakeShadow::remove(const coordinate& turbine) {
+   update(turbine, -1);
+}
+
+int WakeShadow::cell_of(double x, double y) const {
+   int c = std::min(field.columns() - 1, std::max(0, static_cast<int>(x / field.cell_size())));
+   int r = std::min(field.rows() - 1, std::max(0, static_cast<int>(y / field.cell_size())));
+   return r * field.columns() + c;
+}
+
+void WakeShadow::update(const coordinate& turbine, int sign) {
+   int cols = field.columns();
+   int dirs = field.directions();
+   double size = field.cell_size();
+   int own = cell_of(turbine.x, turbine.y);
+   // the cells within reach of the wake
+   double reach = field.wake_length() + size;
+   int c_min = std::max(0, static_cast<int>((turbine.x - reach) / size));
+   int c_max = std::min(cols - 1, static_cast<int>((turbine.x + reach) / size));
+   int r_min = std::max(0, static_cast<int>((turbine.y - reach) / size));
+   int r_max = std::min(field.rows() - 1, static_cast<int>((turbine.y + reach) / size));
+   for (int r = r_min; r <= r_max; ++r) {
+      for (int c = c_min; c <= c_max; ++c) {
+         int cell = r * cols + c;
+         if (field.exposure(cell) == 0.0)
+            continue;
+         double x0 = c * size;
+         double y0 = r * size;
+         double x1 = std::min(x0 + size, field.width());
+         double y1 = std::min(y0 + size, field.height());
+         double dx = 0.5 * (x0 + x1) - turbine.x;
+         double dy = 0.5 * (y0 + y1) - turbine.y;
+         bool changed = false;
+         for (int d = 0; d < dirs; ++d) {
+            double def = field.deficit(d, dx, dy);
+            if (def > 0.0) {
+               double& sum = deficits[cell * dirs + d];
+               sum = std::max(0.0, sum + sign * def * def);
+               changed = true;
+            }
+         }
+         // only the neighbours of its own cell can be covered by a turbine
+         if (std::abs(c - own % cols) <= 1 && std::abs(r - own / cols) <= 1) {
+            double fx = std::max(std::abs(x0 - turbine.x), std::abs(x1 - turbine.x));
+            double fy = std::max(std::abs(y0 - turbine.y), std::abs(y1 - turbine.y));
+            double min_distance = field.min_distance();
+            if (fx * fx + fy * fy < min_distance * min_distance) {
+               blockers[cell] += sign;
+               changed = true;
+            }
+         }
+         if (changed)
+            refresh(cell);
+      }
+   }
+}
+
+void WakeShadow::refresh(int cell) {
+   double yield = 0.0;
+   if (blockers[cell] == 0) {
+      int dirs = field.directions();
+      for (int d = 0; d < dirs; ++d) {
+         double v = std::max(0.0, 1.0 - std::sqrt(deficits[cell * dirs + d]));
+         yield += field.weight(d) * v * v * v;
+      }
+      yield *= field.exposure(cell);
+   }
+   double change = yield - yields[cell];
+   if (change == 0.0)
+      return;
+   yields[cell] = yield;
+   for (std::size_t i = cell + 1; i < tree.size(); i += i & -i) {
+      tree[i] += change;
+   }
+}
+
+double WakeShadow::yield(double x, double y) const {
+   return yields[cell_of(x, y)];
+}
+
+double WakeShadow::total() const {
+   double sum = 0.0;
+   for (std::size_t i = tree.size() - 1; i > 0; i -= i & -i) {
+      sum += tree[i];
+   }
+   return sum;
+}
+
+bool WakeShadow::sample(std::mt19937& engine, double& x, double& y) const {
+   double sum = total();
+   if (sum <= 0.0)
+      return false;
+   std::uniform_real_distribution<double> dist(0.0, 1.0);
+   // descend the tree to the first cell whose prefix sum exceeds the target
+   double target = dist(engine) * sum;
+   std::size_t cells = tree.size() - 1;
+   std::size_t step = 1;
+   while (step * 2 <= cells)
+      step *= 2;
+   std::size_t pos = 0;
+   for (; step > 0; step /= 2) {
+      if (pos + step <= cells && tree[pos + step] <= target) {
+         pos += step;
+         target -= tree[pos];
+      }
+   }
+   // rounding may run past the last cell with a yield
+   int cell = std::min<std::size_t>(pos, cells - 1);
+   while (cell > 0 && yields[cell] == 0.0)
+      --cell;
+   double size = field.cell_size();
+   double x0 = (cell % field.columns()) * size;
+   double y0 = (cell / field.columns()) * size;
+   x = x0 + dist(engine) * (std::min(x0 + size, field.width()) - x0);
+   y = y0 + dist(engine) * (std::min(y0 + size, field.height()) - y0);
+   return true;
+}
+
+void WakeShadow::draw(std::mt19937& engine, double& x, double& y) const {
+   if (sample(engine, x, y))
+      return;
+   std::uniform_real_distribution<double> dist(0.0, 1.0);
+   x = dist(engine) * field.width();
+   y = dist(engine) * field.height();
+}
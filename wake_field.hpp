@@ -0,0 +1,147 @@
+/*
+ * wake_field.hpp
+ *
+ * contains the wind exposure of a scenario and the wake shadow of a layout
+ * on a raster, so that operators can place turbines where they are expected
+ * to yield the most
+ */
+#ifndef BBO_WAKE_FIELD_HPP
+#define BBO_WAKE_FIELD_HPP
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "API/CompetitionScenario.h"
+#include "API/CompiledScenario.h"
+#include "structures.hpp"
+
+/*
+ * WakeField
+ *
+ * precomputes the wind directions of a scenario, weighted by the mean cube
+ * of their wind speed (omega * c^3 * gamma(1 + 3 / k)), and takes the wake
+ * cone of the Kusiak model from the compiled scenario
+ *
+ * the farm is divided into cells of the minimal turbine distance; the
+ * exposure of a cell is the share of its area inside the farm and outside
+ * of the obstacles
+ *
+ * a CompetitionScenario has no wind resource, so all directions get the same
+ * weight there
+ */
+class WakeField {
+public:
+   WakeField(std::shared_ptr<const CompiledScenario> compiled);
+   WakeField(CompetitionScenario& scenario);
+
+   /*
+    * WakeField::deficit
+    *
+    * parameters:
+    *    d - the direction
+    *    dx, dy - the position relative to the turbine causing the wake
+    *
+    * returns:
+    *    the relative velocity deficit at that position, 0 outside of the wake
+    *    (deficits are not cut off here, see wake_length)
+    */
+   double deficit(int d, double dx, double dy) const {
+      return cone.deficit(cos_t[d], sin_t[d], dx, dy);
+   }
+
+   // the distance behind a turbine after which its wake is ignored
+   double wake_length() const { return length; }
+
+   int directions() const { return weights.size(); }
+   // the share of the wind energy which comes from direction d
+   double weight(int d) const { return weights[d]; }
+
+   int columns() const { return cols; }
+   int rows() const { return rws; }
+   double cell_size() const { return size; }
+   double width() const { return farm_width; }
+   double height() const { return farm_height; }
+   double min_distance() const { return 8.0 * radius; }
+   // the usable share of a cell, 0 if it is covered by obstacles
+   double exposure(int cell) const { return exposures[cell]; }
+
+private:
+   void init_raster(double R, double width, double height, const Matrix<double>& obstacles);
+
+   // cosine and sine of each direction, and its share of the wind energy
+   std::vector<double> cos_t;
+   std::vector<double> sin_t;
+   std::vector<double> weights;
+   WakeCone cone;
+   double radius;
+   double length;
+
+   double farm_width;
+   double farm_height;
+   double size;
+   int cols;
+   int rws;
+   std::vector<double> exposures;
+};
+
+/*
+ * WakeShadow
+ *
+ * the expected yield of each cell of a WakeField when the turbines of a
+ * layout shadow it: the exposure times the weighted cube of the wind speed
+ * left over by the wakes at the centre of the cell. cells whose whole area is
+ * too close to a turbine yield nothing
+ *
+ * turbines can be added and removed, which only updates the sums of the
+ * squared deficits, and the yields are kept in a Fenwick tree, so a position
+ * is sampled in proportion to the yield in O(log cells)
+ */
+class WakeShadow {
+public:
+   WakeShadow(const WakeField& field);
+
+   // starts over with the turbines of the layout
+   void reset(const std::vector<coordinate>& layout);
+   void add(const coordinate& turbine);
+   void remove(const coordinate& turbine);
+
+   // the expected yield of the cell containing (x, y)
+   double yield(double x, double y) const;
+   // the sum of the yields of all cells
+   double total() const;
+
+   /*
+    * WakeShadow::sample
+    *
+    * draws a cell in proportion to its yield and a uniform position inside
+    * of the part of it which lies in the farm. the position may still
+    * collide with a turbine or an obstacle, the caller has to check that
+    *
+    * returns:
+    *    false if no cell yields anything
+    */
+   bool sample(std::mt19937& engine, double& x, double& y) const;
+
+   // like sample, but falls back to a uniform position in the farm once no
+   // cell yields anything
+   void draw(std::mt19937& engine, double& x, double& y) const;
+
+private:
+   int cell_of(double x, double y) const;
+   // adds (sign 1) or removes (sign -1) the wake and the blocking of a turbine
+   void update(const coordinate& turbine, int sign);
+   // recomputes the yield of a cell and updates the tree
+   void refresh(int cell);
+
+   const WakeField& field;
+   // the sum of the squared deficits, per cell and direction
+   std::vector<double> deficits;
+   // the number of turbines which are too close to the whole cell
+   std::vector<int> blockers;
+   std::vector<double> yields;
+   // Fenwick tree over the yields, 1-based
+   std::vector<double> tree;
+};
+
+#endif